@@ -1,14 +1,19 @@
 #include "headers/main.h"
-#include "headers/database.h"
+#include "headers/bookspace.h"
 #include "headers/reservation.h"
+#include "headers/table.h"
+#include "headers/cli.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
 #include <ctype.h>
 #include <unistd.h>
 
-//DATABASE CONNECTION
-sqlite3 *db;
+//DATABASE CONTEXT (the menu is a client of libbookspace)
+static Bookspace* app;
+
+//OUTPUT BUFFER FOR RESERVATION TABLES
+static TableRenderer schedule_table;
 
 //LAGAY SA UTILS
 void to_uppercase (char *str) {
@@ -17,12 +22,50 @@ void to_uppercase (char *str) {
     }
 }
 
-int main() {
+// Single-reservation table; the cancel/edit views use the short headers and |---| rules
+static void print_reservation_by_id(const char* reservation_id, int short_header) {
+    ReservationCursor cursor;
+    table_init(&schedule_table, stdout);
+    if (short_header) {
+        table_header(&schedule_table, "Start", "End");
+        table_rule(&schedule_table);
+    } else {
+        table_border(&schedule_table);
+        table_header(&schedule_table, "Start Time", "End Time");
+        table_border(&schedule_table);
+    }
+    if (reservation_cursor_by_id(app, &cursor, reservation_id) == 0) {
+        table_reservations(&schedule_table, &cursor);
+    }
+    if (short_header) {
+        table_rule(&schedule_table);
+    } else {
+        table_border(&schedule_table);
+    }
+    table_flush(&schedule_table);
+}
+
+// 1 = exists, 0 = doesn't exist, -1 = error
+static int reservation_exists(const char* reservation_id) {
+    Reservation found;
+    BookspaceResult result = bookspace_get(app, reservation_id, &found);
+    if (result == BOOKSPACE_NOT_FOUND) {
+        return 0;
+    }
+    return result == BOOKSPACE_OK ? 1 : -1;
+}
+
+int main(int argc, char* argv[]) {
+    // Non-interactive mode: MainProgram <command> [flags] or --script <file|-> (import included)
+    if (argc >= 2) {
+        return cli_main(argc, argv);
+    }
+
     printf("LIBRARY CONSULTATION ROOM RESERVATION SYSTEM\n");
     printf("Initializing system...\n\n");
 
     //Initialize db
-    if (initialize_database() != 0) {
+    if (bookspace_open(NULL, &app) != BOOKSPACE_OK) {
         printf("Error: Failed to initialize database. Exiting...\n");
         pause_screen();
         return 1;
@@ -32,7 +75,7 @@ int main() {
     main_menu();
 
     //Close db
-    close_database();
+    bookspace_close(app);
     
     return 0;
 }
@@ -135,19 +178,24 @@ void view_daily_schedule() {
 
      // display sched
     printf("\nSchedule for %s\n", date);
-    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-    printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-        "Reservation ID", "Date", "Room", "Start Time", "End Time", "Student Name");
-    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
+    table_init(&schedule_table, stdout);
+    table_border(&schedule_table);
+    table_header(&schedule_table, "Start Time", "End Time");
+    table_border(&schedule_table);
 
     // get reservations for the date
-    int result = get_reservations_by_date(date);
+    ReservationCursor cursor;
+    int result = reservation_cursor_by_date(app, &cursor, date);
+    if (result == 0) {
+        result = table_reservations(&schedule_table, &cursor);
+    }
 
     if (result != 0) {
-        printf("| %-112s |\n", "Error retrieving schedule data.");
+        table_message(&schedule_table, "Error retrieving schedule data.");
     }
 
-    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
+    table_border(&schedule_table);
+    table_flush(&schedule_table);
     pause_screen();
     } while (!valid_input);
 }
@@ -171,8 +219,8 @@ void make_reservation(){
         printf("-------------------\n\n");
    
         printf("Available Consultation Rooms:\n");
-        for (int i = 0; i < NUM_ROOMS; i++) {
-            printf("%d. %s\n", i + 1, CONSULTATION_ROOMS[i]);
+        for (int i = 0; i < bookspace_room_count(app); i++) {
+            printf("%d. %s\n", i + 1, bookspace_room(app, i)->name);
         }
         printf("Select consultation room ('cancel' to abort): ");
 
@@ -190,13 +238,13 @@ void make_reservation(){
         }
 
         room_choice = atoi(input_buffer);
-        if (room_choice < 1 || room_choice > NUM_ROOMS) {
+        if (room_choice < 1 || room_choice > bookspace_room_count(app)) {
             printf("Invalid choice. Please try again.\n");
             pause_screen();
             continue;
         }
 
-        strcpy(consultation_room, CONSULTATION_ROOMS[room_choice - 1]);
+        strcpy(consultation_room, bookspace_room(app, room_choice - 1)->name);
         valid = 1;
     } while (!valid);
 
@@ -228,22 +276,12 @@ void make_reservation(){
             continue;
         }
 
-        //ASSUME VALID FOR NOW FOR CHECKING PURPOSES
-        valid = 1;
-
-        //ITERATE THROUGH EACH CHARACTER TO CHECK IF VALID
-        for (int i = 0; i < strlen(student_name); i++) {
-
-            // Check if the character is NOT an alphabet AND NOT a space
-            if (!isalpha((unsigned char)student_name[i]) && student_name[i] != ' ') {
-
-                printf("Name must contain only alphabetic characters and spaces. Please try again.\n");
-                pause_screen();
-                valid = 0; // Set invalid flag
-                break;     // Stop checking the rest of the characters
-            }
-            
+        if (!validate_student_name(student_name)) {
+            printf("Name must contain only alphabetic characters and spaces. Please try again.\n");
+            pause_screen();
+            continue;
         }
+        valid = 1;
     } while (!valid);
 
     // Step 3: Student number
@@ -270,10 +308,7 @@ void make_reservation(){
             return;
         }
         
-        if (strlen(student_num) != 10 || 
-            strspn(student_num, "0123456789") != 8 || 
-            student_num[8] != '-' || 
-            !isalpha((unsigned char)student_num[9])) {// ALPHABET CHECK
+        if (!validate_student_num(student_num)) {
             printf("Invalid student number.\n");
             pause_screen();
             continue;
@@ -312,12 +347,11 @@ void make_reservation(){
             return;
         }
     
-        time_t t = time(NULL); // Grabs current time and stores it in variable t
-        struct tm *today = localtime(&t); // Converts t to localtime as structure broken down to year month day
-        int current_month = today->tm_mon + 1; // Months start at 0 (= January), and +1 is added so 1 = January
+        int current_month;
+        split_day_number(today_day_number(), NULL, &current_month, NULL);
         
         month = atoi(input_buffer);
-        if (month < current_month) {
+        if (month < current_month || month > 12) {
             printf("Invalid month. Please try again.\n");
             pause_screen();
             continue;
@@ -328,7 +362,7 @@ void make_reservation(){
                 mday = 31; break;
             case 4: case 6: case 9: case 11: 
                 mday = 30; break;
-            case 2: 
+            default: // February; month is already 1-12
                 mday = 29; break;
         }
         valid = 1;
@@ -371,14 +405,13 @@ void make_reservation(){
     } while (!valid);
 
     // Auto-set year
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    year = t->tm_year + 1900;
+    split_day_number(today_day_number(), &year, NULL, NULL);
     printf("\nYear has been automatically set to %d.\n", year);
 
-    snprintf(date, sizeof(date), "%02d/%02d/%04d", month, day, year);
-    if (!validate_date(date)) {
-        printf("Invalid date.\n");
+    int date_len = snprintf(date, sizeof(date), "%02d/%02d/%04d", month, day, year);
+    if (date_len >= (int)sizeof(date) || !validate_date(date)) {
+        // validate_date is silent; a viewable date it refuses is in the past
+        printf(validate_date_for_viewing(date) ? "Error: A past date is invalid.\n" : "Invalid date.\n");
         pause_screen();
         return;
     }
@@ -412,18 +445,14 @@ void make_reservation(){
         
         to_uppercase(start_time);
 
-        if (!validate_time(start_time)){
+        if (normalize_time(start_time) < 0){
             printf("Invalid time format. Please try again.\n");
             pause_screen();
             continue;
         }
 
         if (outside_time_bounds(start_time)){
-            pause_screen();
-            continue;
-        }
-
-        if (outside_time_bounds(end_time)){
+            printf("Error: Time must be between 8:00 AM and 8:00 PM.\n");
             pause_screen();
             continue;
         }
@@ -461,12 +490,18 @@ void make_reservation(){
         
         to_uppercase(end_time);
 
-        if (!validate_time(end_time)){
+        if (normalize_time(end_time) < 0){
             printf("Invalid time format. Please try again.\n");
             pause_screen();
             continue;
         }
 
+        if (end_outside_time_bounds(end_time)){
+            printf("Error: Time must be between 8:00 AM and 8:00 PM.\n");
+            pause_screen();
+            continue;
+        }
+
         if (!validate_time_range(start_time, end_time)){
             printf("End time must be after start time. Please try again.\n");
             pause_screen();
@@ -476,7 +511,9 @@ void make_reservation(){
     } while (!valid);
 
     // Step 8: Check for conflicts
-    if (check_time_conflict(date, start_time, end_time, consultation_room)) {
+    int available = 0;
+    if (bookspace_room_available(app, date, start_time, end_time, consultation_room, &available) != BOOKSPACE_OK ||
+        !available) {
         clear_screen();
         printf("MAKE A RESERVATION\n");
         printf("-------------------\n\n");
@@ -494,13 +531,13 @@ void make_reservation(){
     printf("-------------------\n\n");
     printf("Generated Reservation ID: %s\n\n", reservation_id);
     printf("Please confirm your reservation details:\n");
-    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-    printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-        "Reservation ID", "Date", "Room", "Start Time", "End Time", "Student Name");
-    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-    printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-        reservation_id, date, consultation_room, start_time, end_time, student_name);
-    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
+    table_init(&schedule_table, stdout);
+    table_border(&schedule_table);
+    table_header(&schedule_table, "Start Time", "End Time");
+    table_border(&schedule_table);
+    table_cells(&schedule_table, reservation_id, date, consultation_room, start_time, end_time, student_name);
+    table_border(&schedule_table);
+    table_flush(&schedule_table);
     printf("\nConfirm reservation? (Y/N): ");
     
     char confirm;
@@ -513,54 +550,16 @@ void make_reservation(){
     clear_input_buffer();
     
     // Create reservation
-    int result = insert_reservation(student_name, student_num, date, start_time, end_time, reservation_id, consultation_room);
-    if (result == 0) {
+    BookingRequest request = { student_name, student_num, date, start_time, end_time, consultation_room, reservation_id };
+    BookspaceResult result = bookspace_book(app, &request, NULL, 0);
+    if (result == BOOKSPACE_OK) {
         printf("\nReservation created successfully!\n");
     } else {
-        printf("\nFailed to create reservation.\n");
+        printf("\n%s\nFailed to create reservation.\n", bookspace_result_message(result));
     }
     pause_screen();
 }
 
-void generate_reservation_id(char* out_id, size_t out_size, const char* reservation_date) {
-    // Simple format: TODAY_DATE-RESERVATION_DATE-TIMESTAMP
-    // Example: 101325-120125-123456 (MMDDYY-MMDDYY-HHMMSS)
-    
-    if (out_size < 20) {
-        if (out_size > 0) out_id[0] = '\0';
-        return;
-    }
-    
-    // Get current time
-    time_t now = time(NULL);
-    struct tm* today = localtime(&now);
-    
-    // Today's date in MMDDYY format
-    char today_str[7];
-    strftime(today_str, sizeof(today_str), "%m%d%y", today);
-    
-    // Convert reservation date from MM/DD/YYYY to MMDDYY format
-    char res_date_str[8]; // Increased size to [prevent truncation]
-    if (strlen(reservation_date) == 10 && reservation_date[2] == '/' && reservation_date[5] == '/') {
-        int month, day, year;
-        if (sscanf(reservation_date, "%2d/%2d/%4d", &month, &day, &year) == 3)   {
-            snprintf(res_date_str, sizeof(res_date_str), "%02d%02d%02d", 
-                     month, day, year % 100);
-        } else {
-            strcpy(res_date_str, "000000");
-        }
-    } else {
-        strcpy(res_date_str, "000000");
-    }
-    
-    // timestamp for uniq (HHMMSS)
-    char timestamp_str[7];
-    strftime(timestamp_str, sizeof(timestamp_str), "%H%M%S", today);
-    
-    // ID FORMAT: TODAY_DATE-RESERVATION_DATE-TIMESTAMP
-    snprintf(out_id, out_size, "%s-%s-%s", today_str, res_date_str, timestamp_str);
-}
-
 void cancel_reservation(){
     //cancel logic here
     int choice;
@@ -627,11 +626,7 @@ void cancel_reservation(){
             
             // Display
             printf("\nReservation found:\n");
-            printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n", 
-                   "Reservation ID", "Date", "Room", "Start", "End", "Student Name");
-            printf("|----------------------|------------|-----------------|------------|------------|---------------------------|\n");
-            get_reservations_by_id(reservation_id);
-            printf("|----------------------|------------|-----------------|------------|------------|---------------------------|\n");
+            print_reservation_by_id(reservation_id, 1);
             
             // Ask for confirmation
             printf("\nAre you sure you want to cancel this reservation? (Y/N): ");
@@ -640,11 +635,11 @@ void cancel_reservation(){
             clear_input_buffer();
             
             if (confirm == 'Y' || confirm == 'y') {
-                int result = delete_reservation(reservation_id);
-                if (result == 0) {
+                BookspaceResult result = bookspace_cancel(app, reservation_id);
+                if (result == BOOKSPACE_OK) {
                     printf("\nReservation '%s' successfully cancelled.\n", reservation_id);
                 } else {
-                    printf("\nFailed to cancel reservation.\n");
+                    printf("\n%s\nFailed to cancel reservation.\n", bookspace_result_message(result));
                 }
             } else {
                 printf("\nCancellation aborted.\n");
@@ -726,11 +721,7 @@ void edit_reservation(){
 
                     // DISPLAY
                     printf("\nReservation found:\n");
-                    printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n", 
-                           "Reservation ID", "Date", "Room", "Start", "End", "Student Name");
-                    printf("|----------------------|------------|-----------------|------------|------------|---------------------------|\n");
-                    get_reservations_by_id(reservation_id);
-                    printf("|----------------------|------------|-----------------|------------|------------|---------------------------|\n");
+                    print_reservation_by_id(reservation_id, 1);
                     printf("\nPress Enter to continue...");
                     clear_input_buffer();
 
@@ -803,10 +794,7 @@ void edit_reservation(){
                             break;
                         }
 
-                        if (strlen(student_num) != 10 || 
-            strspn(student_num, "0123456789") != 8 || 
-            student_num[8] != '-' || 
-            !isalpha((unsigned char)student_num[9])) {// ALPHABET CHECK
+                        if (!validate_student_num(student_num)) {
             printf("Invalid student number.\n");
             pause_screen();
             continue;
@@ -827,8 +815,8 @@ void edit_reservation(){
                         printf("Student Number: %s\n\n", student_num);
                         
                         printf("Available Consultation Rooms:\n");
-                        for (int i = 0; i < NUM_ROOMS; i++) {
-                            printf("%d. %s\n", i + 1, CONSULTATION_ROOMS[i]);
+                        for (int i = 0; i < bookspace_room_count(app); i++) {
+                            printf("%d. %s\n", i + 1, bookspace_room(app, i)->name);
                         }
                         printf("Select consultation room (or 'cancel' to abort): ");
 
@@ -849,13 +837,13 @@ void edit_reservation(){
                         }
 
                         int room_choice = atoi(input_buffer);
-                        if (room_choice < 1 || room_choice > NUM_ROOMS) {
+                        if (room_choice < 1 || room_choice > bookspace_room_count(app)) {
                             printf("Invalid choice. Please try again.\n");
                             pause_screen();
                             continue;
                         }
                         
-                        strcpy(consultation_room, CONSULTATION_ROOMS[room_choice - 1]);
+                        strcpy(consultation_room, bookspace_room(app, room_choice - 1)->name);
                         valid = 1;
                     } while (!valid);
                     
@@ -907,7 +895,7 @@ void edit_reservation(){
                                 mday = 31; break;
                             case 4: case 6: case 9: case 11: 
                                 mday = 30; break;
-                            case 2: 
+                            default: // February; month is already 1-12
                                 mday = 29; break;
                         }
                         valid = 1;
@@ -957,9 +945,7 @@ void edit_reservation(){
                     if (valid_reservation) break;
                     
                     // AUTO SET YEAR
-                    time_t now = time(NULL);
-                    struct tm *t = localtime(&now);
-                    year = t->tm_year + 1900;
+                    split_day_number(today_day_number(), &year, NULL, NULL);
                     printf("\nYear has been automatically set to %d.\n", year);
                     
                     snprintf(date, sizeof(date), "%02d/%02d/%04d", month, day, year);
@@ -996,7 +982,7 @@ void edit_reservation(){
 
                         to_uppercase(start_time);
 
-                        if (!validate_time(start_time)){
+                        if (normalize_time(start_time) < 0){
                             printf("Invalid time format. Please try again.\n");
                             pause_screen();
                             continue;
@@ -1039,7 +1025,7 @@ void edit_reservation(){
 
                         to_uppercase(end_time);
 
-                        if (!validate_time(end_time)){
+                        if (normalize_time(end_time) < 0){
                             printf("Invalid time format. Please try again.\n");
                             pause_screen();
                             continue;
@@ -1060,13 +1046,13 @@ void edit_reservation(){
                     printf("EDIT A RESERVATION\n");
                     printf("--------------------\n\n");
                     printf("New reservation details:\n");
-                    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-                    printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-                        "Reservation ID", "Date", "Room", "Start Time", "End Time", "Student Name");
-                    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-                    printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-                        reservation_id, date, consultation_room, start_time, end_time, student_name);
-                    printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
+                    table_init(&schedule_table, stdout);
+                    table_border(&schedule_table);
+                    table_header(&schedule_table, "Start Time", "End Time");
+                    table_border(&schedule_table);
+                    table_cells(&schedule_table, reservation_id, date, consultation_room, start_time, end_time, student_name);
+                    table_border(&schedule_table);
+                    table_flush(&schedule_table);
                     
                     printf("\nConfirm changes? (Y/N): ");
                     char confirm;
@@ -1074,12 +1060,12 @@ void edit_reservation(){
                     clear_input_buffer();
                     
                     if (confirm == 'Y' || confirm == 'y') {
-                        int result = update_reservation(reservation_id, student_name, student_num, 
-                                                       date, start_time, end_time, consultation_room);
-                        if (result == 0) {
-                            //printf("\nReservation '%s' successfully updated.\n", reservation_id);
+                        BookingRequest request = { student_name, student_num, date, start_time, end_time, consultation_room, NULL };
+                        BookspaceResult result = bookspace_edit(app, reservation_id, &request);
+                        if (result == BOOKSPACE_OK) {
+                            printf("Reservation [%s] updated successfully.\n", reservation_id);
                         } else {
-                            printf("\nFailed to update reservation.\n");
+                            printf("\n%s\nFailed to update reservation.\n", bookspace_result_message(result));
                         }
                     } else {
                         printf("\nUpdate cancelled.\n");
@@ -1146,15 +1132,20 @@ void search_reservations(){
             }
 
             printf("\nSearch results for '%s':\n", search_term);
-            printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-            printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-                "Reservation ID", "Date", "Room", "Start Time", "End Time", "Student Name");
-            printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-            int result = get_reservations_by_name(search_term);
+            table_init(&schedule_table, stdout);
+            table_border(&schedule_table);
+            table_header(&schedule_table, "Start Time", "End Time");
+            table_border(&schedule_table);
+            ReservationCursor cursor;
+            int result = reservation_cursor_by_name(app, &cursor, search_term);
+            if (result == 0) {
+                result = table_reservations(&schedule_table, &cursor);
+            }
                 if (result != 0) {
-                    printf("| %-112s |\n", "No reservations found.");
+                    table_message(&schedule_table, "No reservations found.");
                 }
-            printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
+            table_border(&schedule_table);
+            table_flush(&schedule_table);
             pause_screen();
             break;
 
@@ -1199,12 +1190,7 @@ void search_reservations(){
                 }
 
                 printf("\nSearch results for ID '%s':\n", search_id);
-                printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-                printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n",
-                    "Reservation ID", "Date", "Room", "Start Time", "End Time", "Student Name");
-                printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
-                get_reservations_by_id(search_id);
-                printf("+----------------------+------------+-----------------+------------+------------+---------------------------+\n");
+                print_reservation_by_id(search_id, 0);
                     
                 pause_screen();
                 valid_id = 1;
@@ -1227,16 +1213,18 @@ void search_reservations(){
 void exit_program(){
     printf("Exiting the program...\n");
     sleep(3); //3s DELAY BEFORE EXITING
-    sqlite3_close(db); //CLOSE DB
+    bookspace_close(app); //CLOSE DB (finalizes cached statements)
     exit(0); //EXIT PROGRAM
 }
 
 void clear_screen(){
-    #ifdef _WIN32 // checks if the code is compiling on Windows
-    system("cls"); // executes the Windows command to clear the screen
-    #else
-    system("clear"); // Unix equivalent
-    #endif
+    // ANSI clear + cursor home instead of spawning a shell for clear/cls.
+    // Skipped when stdout is not a terminal, so piped output stays clean.
+    if (!isatty(STDOUT_FILENO)) {
+        return;
+    }
+    fputs("\033[H\033[2J", stdout);
+    fflush(stdout);
 }
 
 void pause_screen(){
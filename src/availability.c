@@ -0,0 +1,137 @@
+#include "headers/availability.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Slot index of a minute value, clamped to library hours
+static int slot_floor(int minutes) {
+    int slot = (minutes - LIBRARY_OPEN_MINUTES) / SLOT_MINUTES;
+    if (minutes < LIBRARY_OPEN_MINUTES) slot = 0;
+    return slot > SLOTS_PER_DAY ? SLOTS_PER_DAY : slot;
+}
+
+static int slot_ceil(int minutes) {
+    if (minutes <= LIBRARY_OPEN_MINUTES) return 0;
+    int slot = (minutes - LIBRARY_OPEN_MINUTES + SLOT_MINUTES - 1) / SLOT_MINUTES;
+    return slot > SLOTS_PER_DAY ? SLOTS_PER_DAY : slot;
+}
+
+// Bits [first, last) of a 192-bit mask
+static void slot_mask_bits(int first, int last, SlotMask* mask) {
+    for (int w = 0; w < SLOT_WORDS; w++) {
+        int lo = first > w * 64 ? first : w * 64;
+        int hi = last < (w + 1) * 64 ? last : (w + 1) * 64;
+        if (lo >= hi) {
+            mask->words[w] = 0;
+        } else {
+            int width = hi - lo;
+            uint64_t bits = width == 64 ? ~(uint64_t)0 : (((uint64_t)1 << width) - 1);
+            mask->words[w] = bits << (lo - w * 64);
+        }
+    }
+}
+
+void slot_mask_for_range(int start_min, int end_min, SlotMask* mask) {
+    // Every slot the range touches, even partly
+    slot_mask_bits(slot_floor(start_min), slot_ceil(end_min), mask);
+}
+
+int day_availability_init(DayAvailability* avail, int day, int room_count) {
+    avail->busy = calloc((size_t)SLOT_WORDS * (size_t)room_count, sizeof(uint64_t));
+    if (!avail->busy) {
+        avail->day = -1;
+        avail->room_count = 0;
+        return 1;
+    }
+    avail->day = day;
+    avail->room_count = room_count;
+    return 0;
+}
+
+void day_availability_free(DayAvailability* avail) {
+    free(avail->busy);
+    avail->busy = NULL;
+    avail->day = -1;
+    avail->room_count = 0;
+}
+
+void day_availability_mark(DayAvailability* avail, int room, int start_min, int end_min) {
+    SlotMask mask;
+    slot_mask_for_range(start_min, end_min, &mask);
+    for (int w = 0; w < SLOT_WORDS; w++) {
+        avail->busy[w * avail->room_count + room] |= mask.words[w];
+    }
+}
+
+int availability_range_free(const DayAvailability* avail, int room, int start_min, int end_min) {
+    SlotMask mask;
+    slot_mask_for_range(start_min, end_min, &mask);
+
+    uint64_t hit = 0;
+    for (int w = 0; w < SLOT_WORDS; w++) {
+        hit |= avail->busy[w * avail->room_count + room] & mask.words[w];
+    }
+    return hit == 0;
+}
+
+int availability_free_rooms(const DayAvailability* avail, int start_min, int end_min, int* rooms_out) {
+    SlotMask mask;
+    slot_mask_for_range(start_min, end_min, &mask);
+
+    // Rooms are processed in blocks; for each word the inner loop is a plain AND/OR
+    // over consecutive rooms, which the compiler turns into vector instructions
+    enum { BLOCK = 64 };
+    uint64_t hits[BLOCK];
+    int n = avail->room_count;
+    int count = 0;
+
+    for (int base = 0; base < n; base += BLOCK) {
+        int block = n - base < BLOCK ? n - base : BLOCK;
+        memset(hits, 0, sizeof(hits));
+        for (int w = 0; w < SLOT_WORDS; w++) {
+            const uint64_t* row = &avail->busy[w * n + base];
+            uint64_t m = mask.words[w];
+            for (int r = 0; r < block; r++) {
+                hits[r] |= row[r] & m;
+            }
+        }
+        for (int r = 0; r < block; r++) {
+            if (hits[r] == 0) {
+                if (rooms_out) rooms_out[count] = base + r;
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+void availability_cache_init(AvailabilityCache* cache) {
+    for (int i = 0; i < AVAILABILITY_CACHE_DAYS; i++) {
+        cache->days[i].day = -1;
+        cache->days[i].room_count = 0;
+        cache->days[i].busy = NULL;
+    }
+}
+
+void availability_cache_free(AvailabilityCache* cache) {
+    for (int i = 0; i < AVAILABILITY_CACHE_DAYS; i++) {
+        day_availability_free(&cache->days[i]);
+    }
+}
+
+DayAvailability* availability_cache_find(AvailabilityCache* cache, int day) {
+    DayAvailability* avail = &cache->days[day % AVAILABILITY_CACHE_DAYS];
+    return avail->day == day ? avail : NULL;
+}
+
+DayAvailability* availability_cache_slot(AvailabilityCache* cache, int day, int room_count) {
+    // Empty bitmaps for day, evicting whichever day shared the slot
+    DayAvailability* avail = &cache->days[day % AVAILABILITY_CACHE_DAYS];
+    day_availability_free(avail);
+    return day_availability_init(avail, day, room_count) == 0 ? avail : NULL;
+}
+
+void availability_cache_drop(AvailabilityCache* cache, int day) {
+    DayAvailability* avail = availability_cache_find(cache, day);
+    if (avail) day_availability_free(avail);
+}
@@ -0,0 +1,328 @@
+#include "headers/bookspace.h"
+#include "headers/reservation.h"
+#include "headers/availability.h"
+#include "headers/stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Benchmark driver for the reservation core: fills a fresh database with synthetic
+// bookings and times the hot paths through the public API. Prints one JSON object,
+// so runs of different builds can be diffed or charted.
+//
+//   bookspace_bench [--rooms N] [--days D] [--density F] [--seed S] [--samples N]
+//                   [--single N] [--db PATH] [--out FILE] [--engine tuned|stock]
+//
+// --engine stock undoes the runtime side of the SQLite tuning (memory statistics on,
+// serialized connections) to measure it against the default build.
+
+#define BENCH_DEFAULT_DB "data/bench.db"
+#define BENCH_SLOT_MINUTES 30
+#define BENCH_GROUP_SIZE 500
+#define BENCH_MAX_DAYS 1500           // bookings must stay within five years of today
+#define BENCH_PARSE_CALLS 1000000
+
+typedef struct {
+    int rooms;
+    int days;
+    double density;                   // share of 30-minute slots booked
+    unsigned long long seed;
+    int samples;                      // timed calls per latency measurement
+    int single;                       // bookings committed one transaction each
+    const char* db_path;
+    const char* out_path;
+    int stock_engine;                 // 1 = SQLite's general-purpose settings
+} BenchConfig;
+
+static const char* FIRST_NAMES[] = { "Ann", "Ben", "Carla", "Dmitri", "Elena", "Farouk", "Grace", "Hiro",
+                                     "Ines", "Jon", "Kwame", "Lena", "Marco", "Nadia", "Omar", "Priya" };
+static const char* LAST_NAMES[] = { "Lee", "Smith", "Garcia", "Nguyen", "Okafor", "Rossi", "Kim", "Patel",
+                                    "Silva", "Cohen", "Novak", "Ivanova", "Mensah", "Haddad", "Larsen", "Moreau" };
+#define NUM_FIRST_NAMES (sizeof(FIRST_NAMES) / sizeof(FIRST_NAMES[0]))
+#define NUM_LAST_NAMES (sizeof(LAST_NAMES) / sizeof(LAST_NAMES[0]))
+
+//RANDOM (xorshift64*, so every platform generates the same data for a seed)
+
+static unsigned long long rng_state;
+
+static unsigned long long next_random(void) {
+    rng_state ^= rng_state >> 12;
+    rng_state ^= rng_state << 25;
+    rng_state ^= rng_state >> 27;
+    return rng_state * 2685821657736338717ULL;
+}
+
+static int random_below(int n) {
+    return (int)(next_random() % (unsigned long long)n);
+}
+
+static double random_unit(void) {
+    return (next_random() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+//GENERATORS
+
+typedef struct {
+    char name[MAX_NAME_LENGTH];
+    char student_num[MAX_STUD_ID_LENGTH];
+    char date[MAX_DATE_LENGTH];
+    char start[MAX_TIME_LENGTH];
+    char end[MAX_TIME_LENGTH];
+    BookingRequest request;
+} SyntheticBooking;
+
+static void make_booking(SyntheticBooking* booking, int day, const Room* room, int start_min, int minutes) {
+    snprintf(booking->name, sizeof(booking->name), "%s %s",
+             FIRST_NAMES[random_below(NUM_FIRST_NAMES)], LAST_NAMES[random_below(NUM_LAST_NAMES)]);
+    snprintf(booking->student_num, sizeof(booking->student_num), "2024%04d-%c",
+             random_below(10000), 'A' + random_below(26));
+    day_number_to_date(day, booking->date);
+    minutes_to_time_24hour(start_min, booking->start);
+    minutes_to_time_24hour(start_min + minutes, booking->end);
+
+    BookingRequest request = { booking->name, booking->student_num, booking->date, booking->start, booking->end,
+                               room->name, NULL };
+    booking->request = request;
+}
+
+//MEASUREMENT
+
+static int compare_ns(const void* a, const void* b) {
+    long long x = *(const long long*)a, y = *(const long long*)b;
+    return (x > y) - (x < y);
+}
+
+// Writes "name":{samples, percentiles in ns} from the (unsorted) samples
+static void write_latency(FILE* out, const char* name, long long* ns, int count, const char* extra) {
+    qsort(ns, (size_t)count, sizeof(*ns), compare_ns);
+    long long total = 0;
+    for (int i = 0; i < count; i++) total += ns[i];
+    fprintf(out, "    \"%s\": {\"samples\": %d, \"mean_ns\": %lld, \"p50_ns\": %lld, \"p90_ns\": %lld, "
+                 "\"p99_ns\": %lld, \"max_ns\": %lld%s}",
+            name, count, count ? total / count : 0, count ? ns[count / 2] : 0, count ? ns[count * 9 / 10] : 0,
+            count ? ns[count * 99 / 100] : 0, count ? ns[count - 1] : 0, extra ? extra : "");
+}
+
+static void write_throughput(FILE* out, const char* name, long rows, long long ns) {
+    fprintf(out, "    \"%s\": {\"rows\": %ld, \"seconds\": %.6f, \"rows_per_sec\": %.1f}",
+            name, rows, ns / 1e9, ns > 0 ? rows / (ns / 1e9) : 0.0);
+}
+
+static long long drain_cursor(ReservationCursor* cursor, long* rows) {
+    ReservationRow row;
+    long long started = stats_now_ns();
+    while (reservation_cursor_next(cursor, &row) == 1) {
+        (*rows)++;
+    }
+    reservation_cursor_close(cursor);
+    return stats_now_ns() - started;
+}
+
+static int parse_args(int argc, char* argv[], BenchConfig* config) {
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) return 1;
+        const char* value = argv[++i];
+        if (strcmp(argv[i - 1], "--rooms") == 0) config->rooms = atoi(value);
+        else if (strcmp(argv[i - 1], "--days") == 0) config->days = atoi(value);
+        else if (strcmp(argv[i - 1], "--density") == 0) config->density = atof(value);
+        else if (strcmp(argv[i - 1], "--seed") == 0) config->seed = strtoull(value, NULL, 10);
+        else if (strcmp(argv[i - 1], "--samples") == 0) config->samples = atoi(value);
+        else if (strcmp(argv[i - 1], "--single") == 0) config->single = atoi(value);
+        else if (strcmp(argv[i - 1], "--db") == 0) config->db_path = value;
+        else if (strcmp(argv[i - 1], "--out") == 0) config->out_path = value;
+        else if (strcmp(argv[i - 1], "--engine") == 0 && strcmp(value, "tuned") == 0) config->stock_engine = 0;
+        else if (strcmp(argv[i - 1], "--engine") == 0 && strcmp(value, "stock") == 0) config->stock_engine = 1;
+        else return 1;
+    }
+    return 0;
+}
+
+static void remove_database(const char* path) {
+    char name[512];
+    remove(path);
+    snprintf(name, sizeof(name), "%s-wal", path);
+    remove(name);
+    snprintf(name, sizeof(name), "%s-shm", path);
+    remove(name);
+}
+
+int main(int argc, char* argv[]) {
+    BenchConfig config = { 4, 90, 0.5, 1, 1000, 1000, BENCH_DEFAULT_DB, NULL, 0 };
+    if (parse_args(argc, argv, &config) != 0 || config.days < 1 || config.samples < 1 || config.single < 0 ||
+        config.density < 0 || config.density > 1 || config.rooms < 1) {
+        fprintf(stderr, "usage: bookspace_bench [--rooms N] [--days D] [--density 0..1] [--seed S] [--samples N]\n"
+                        "                       [--single N] [--db PATH] [--out FILE] [--engine tuned|stock]\n");
+        return 2;
+    }
+    int slots_per_day = (LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES) / BENCH_SLOT_MINUTES;
+    int single_days = (config.single + config.rooms * slots_per_day - 1) / (config.rooms * slots_per_day);
+    if (config.days + single_days > BENCH_MAX_DAYS) {
+        config.days = BENCH_MAX_DAYS - single_days;
+        fprintf(stderr, "Note: bookings must fall within five years; using %d days.\n", config.days);
+    }
+    rng_state = config.seed ? config.seed : 1;
+
+    FILE* out = config.out_path ? fopen(config.out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "Cannot open %s\n", config.out_path);
+        return 1;
+    }
+
+    remove_database(config.db_path);
+    DatabaseConfig db_config;
+    database_config_defaults(&db_config);
+    db_config.path = config.db_path;
+    Bookspace* bs = NULL;
+    long long started = stats_now_ns();
+    if (config.stock_engine) {
+        // Settle the process-wide settings before bookspace_open() applies its own
+        sqlite3_config(SQLITE_CONFIG_MEMSTATUS, 1);
+        sqlite3_initialize();
+        db_config.serialized = 1;
+    }
+    if (bookspace_open(&db_config, &bs) != BOOKSPACE_OK) {
+        fprintf(stderr, "Cannot open %s\n", config.db_path);
+        return 1;
+    }
+    long long open_ns = stats_now_ns() - started;
+
+    // The catalog starts with four rooms; larger runs add their own
+    for (int n = bookspace_room_count(bs) + 1; n <= config.rooms; n++) {
+        char name[MAX_ROOM_LENGTH];
+        snprintf(name, sizeof(name), "Bench Room %d", n);
+        if (bookspace_add_room(bs, name, 4, NULL, NULL, NULL) != BOOKSPACE_OK) {
+            fprintf(stderr, "Cannot add %s\n", name);
+            return 1;
+        }
+    }
+    int first_day = today_day_number() + 1;
+
+    fprintf(out, "{\n  \"bench\": \"bookspace\",\n  \"sqlite_version\": \"%s\",\n", sqlite3_libversion());
+    fprintf(out, "  \"engine\": {\"settings\": \"%s\", \"threadsafe\": %d, \"tuned_build\": %s},\n",
+            config.stock_engine ? "stock" : "tuned", sqlite3_threadsafe(),
+            sqlite3_compileoption_used("DEFAULT_MEMSTATUS=0") ? "true" : "false");
+    fprintf(out, "  \"config\": {\"rooms\": %d, \"days\": %d, \"density\": %.3f, \"seed\": %llu, \"samples\": %d, "
+                 "\"single\": %d},\n", config.rooms, config.days, config.density, config.seed, config.samples,
+            config.single);
+    fprintf(out, "  \"results\": {\n    \"open_ns\": %lld,\n", open_ns);
+
+    // Bulk load: every slot booked with probability density, BENCH_GROUP_SIZE per commit
+    SyntheticBooking booking;
+    long inserted = 0, rejected = 0;
+    started = stats_now_ns();
+    bookspace_begin_group(bs);
+    for (int d = 0; d < config.days; d++) {
+        for (int room = 0; room < config.rooms; room++) {
+            for (int s = 0; s < slots_per_day; s++) {
+                if (random_unit() >= config.density) continue;
+                make_booking(&booking, first_day + d, bookspace_room(bs, room),
+                             LIBRARY_OPEN_MINUTES + s * BENCH_SLOT_MINUTES, BENCH_SLOT_MINUTES);
+                if (bookspace_book(bs, &booking.request, NULL, 0) == BOOKSPACE_OK) inserted++;
+                else rejected++;
+                if ((inserted + rejected) % BENCH_GROUP_SIZE == 0) {
+                    bookspace_commit_group(bs);
+                    bookspace_begin_group(bs);
+                }
+            }
+        }
+    }
+    bookspace_commit_group(bs);
+    write_throughput(out, "insert_grouped", inserted, stats_now_ns() - started);
+    fputs(",\n", out);
+
+    // One transaction (and one commit) per booking, on days after the bulk load
+    long single = 0;
+    started = stats_now_ns();
+    for (int i = 0; i < config.single; i++) {
+        int slot = i % (config.rooms * slots_per_day);
+        make_booking(&booking, first_day + config.days + i / (config.rooms * slots_per_day),
+                     bookspace_room(bs, slot / slots_per_day),
+                     LIBRARY_OPEN_MINUTES + (slot % slots_per_day) * BENCH_SLOT_MINUTES, BENCH_SLOT_MINUTES);
+        if (bookspace_book(bs, &booking.request, NULL, 0) == BOOKSPACE_OK) single++;
+    }
+    write_throughput(out, "insert_single", single, stats_now_ns() - started);
+    fputs(",\n", out);
+
+    long long* ns = malloc((size_t)config.samples * sizeof(*ns));
+    if (!ns) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+
+    // Conflict checks: random 30 to 120 minute ranges on loaded days
+    int busy = 0;
+    for (int i = 0; i < config.samples; i++) {
+        int minutes = BENCH_SLOT_MINUTES * (1 + random_below(4));
+        int start_min = LIBRARY_OPEN_MINUTES + BENCH_SLOT_MINUTES * random_below(slots_per_day - 3);
+        make_booking(&booking, first_day + random_below(config.days), bookspace_room(bs, random_below(config.rooms)),
+                     start_min, minutes);
+        int available = 0;
+        started = stats_now_ns();
+        bookspace_room_available(bs, booking.date, booking.start, booking.end, booking.request.consultation_room,
+                                 &available);
+        ns[i] = stats_now_ns() - started;
+        busy += !available;
+    }
+    char extra[96];
+    snprintf(extra, sizeof(extra), ", \"busy_share\": %.3f", (double)busy / config.samples);
+    write_latency(out, "conflict_check", ns, config.samples, extra);
+    fputs(",\n", out);
+
+    // Day schedule scans, rows read through the cursor
+    long rows = 0;
+    for (int i = 0; i < config.samples; i++) {
+        ReservationCursor cursor;
+        reservation_cursor_by_day(bs, &cursor, first_day + random_below(config.days));
+        ns[i] = drain_cursor(&cursor, &rows);
+    }
+    snprintf(extra, sizeof(extra), ", \"rows_per_scan\": %.1f", (double)rows / config.samples);
+    write_latency(out, "scan_by_date", ns, config.samples, extra);
+    fputs(",\n", out);
+
+    // Name search: substring of a generated last name, as typed at the desk
+    rows = 0;
+    for (int i = 0; i < config.samples; i++) {
+        char term[8];
+        const char* last = LAST_NAMES[random_below(NUM_LAST_NAMES)];
+        snprintf(term, sizeof(term), "%.4s", last + random_below((int)strlen(last) - 2));
+        ReservationCursor cursor;
+        started = stats_now_ns();
+        reservation_cursor_by_name(bs, &cursor, term);
+        drain_cursor(&cursor, &rows);
+        ns[i] = stats_now_ns() - started; // includes the lookup before the first row
+    }
+    snprintf(extra, sizeof(extra), ", \"rows_per_search\": %.1f", (double)rows / config.samples);
+    write_latency(out, "name_search", ns, config.samples, extra);
+    fputs(",\n", out);
+
+    // Pure parsing and formatting cost, no database
+    static const char* TIMES[] = { "8:00 AM", "10:30AM", "4PM", "13:45", "7:15 pm", "12:00 PM", "9:05", "11:59 AM" };
+    const int num_times = (int)(sizeof(TIMES) / sizeof(TIMES[0]));
+    volatile int sink = 0;
+    started = stats_now_ns();
+    for (int i = 0; i < BENCH_PARSE_CALLS; i++) {
+        sink += validate_time(TIMES[i % num_times]);
+    }
+    fprintf(out, "    \"validate_time\": {\"calls\": %d, \"ns_per_call\": %.2f},\n", BENCH_PARSE_CALLS,
+            (double)(stats_now_ns() - started) / BENCH_PARSE_CALLS);
+
+    char time_12[MAX_TIME_LENGTH], time_24[MAX_TIME_LENGTH];
+    started = stats_now_ns();
+    for (int i = 0; i < BENCH_PARSE_CALLS; i++) {
+        strcpy(time_12, TIMES[i % num_times]);
+        format_time_24hour(time_12, time_24);
+        sink += time_24[0];
+    }
+    fprintf(out, "    \"format_time_24hour\": {\"calls\": %d, \"ns_per_call\": %.2f}\n", BENCH_PARSE_CALLS,
+            (double)(stats_now_ns() - started) / BENCH_PARSE_CALLS);
+    (void)sink;
+
+    fputs("  }\n}\n", out);
+    free(ns);
+    bookspace_close(bs);
+    if (out != stdout) {
+        fclose(out);
+    }
+    fprintf(stderr, "Loaded %ld bookings (%ld rejected) into %s.\n", inserted, rejected, config.db_path);
+    return 0;
+}
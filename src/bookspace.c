@@ -0,0 +1,428 @@
+#include "headers/bookspace.h"
+#include "headers/database.h"
+#include "headers/reservation.h"
+#include "headers/availability.h"
+#include "headers/main.h"
+#include "headers/stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// libbookspace front end: validates user-level input, converts it to the storage
+// encoding and hands it to the slot-level functions in db.c
+
+static const char* RESULT_MESSAGES[] = {
+    [BOOKSPACE_OK] = "OK",
+    [BOOKSPACE_NOT_FOUND] = "Reservation not found.",
+    [BOOKSPACE_CONFLICT] = "Time conflict detected! The consultation room is already booked during this time.",
+    [BOOKSPACE_DUPLICATE_ID] = "Reservation ID already exists.",
+    [BOOKSPACE_INVALID_NAME] = "Name must contain only alphabetic characters and spaces.",
+    [BOOKSPACE_INVALID_STUDENT_NUM] = "Invalid student number.",
+    [BOOKSPACE_INVALID_DATE] = "Invalid date. Please use MM/DD/YYYY.",
+    [BOOKSPACE_PAST_DATE] = "A past date is invalid.",
+    [BOOKSPACE_INVALID_TIME] = "Invalid time format.",
+    [BOOKSPACE_OUTSIDE_HOURS] = "Time must be within the room's open hours (8:00 AM - 8:00 PM at most).",
+    [BOOKSPACE_BAD_RANGE] = "End time must be after start time.",
+    [BOOKSPACE_UNKNOWN_ROOM] = "Unknown consultation room.",
+    [BOOKSPACE_INVALID_ROOM] = "Room names must be 1-49 characters and capacity at least 1.",
+    [BOOKSPACE_DUPLICATE_ROOM] = "A room with that name already exists.",
+    [BOOKSPACE_INVALID_ID] = "Reservation ID is too long.",
+    [BOOKSPACE_BUSY] = "The database is busy. Please try again.",
+    [BOOKSPACE_ERROR] = "Database error."
+};
+
+// Stable identifiers for machine-readable output
+static const char* RESULT_NAMES[] = {
+    [BOOKSPACE_OK] = "ok",
+    [BOOKSPACE_NOT_FOUND] = "not_found",
+    [BOOKSPACE_CONFLICT] = "conflict",
+    [BOOKSPACE_DUPLICATE_ID] = "duplicate_id",
+    [BOOKSPACE_INVALID_NAME] = "invalid_name",
+    [BOOKSPACE_INVALID_STUDENT_NUM] = "invalid_student_num",
+    [BOOKSPACE_INVALID_DATE] = "invalid_date",
+    [BOOKSPACE_PAST_DATE] = "past_date",
+    [BOOKSPACE_INVALID_TIME] = "invalid_time",
+    [BOOKSPACE_OUTSIDE_HOURS] = "outside_hours",
+    [BOOKSPACE_BAD_RANGE] = "bad_range",
+    [BOOKSPACE_UNKNOWN_ROOM] = "unknown_room",
+    [BOOKSPACE_INVALID_ROOM] = "invalid_room",
+    [BOOKSPACE_DUPLICATE_ROOM] = "duplicate_room",
+    [BOOKSPACE_INVALID_ID] = "invalid_id",
+    [BOOKSPACE_BUSY] = "busy",
+    [BOOKSPACE_ERROR] = "error"
+};
+
+const char* bookspace_result_name(BookspaceResult result) {
+    if ((int)result < 0 || result > BOOKSPACE_ERROR) {
+        return "unknown";
+    }
+    return RESULT_NAMES[result];
+}
+
+const char* bookspace_result_message(BookspaceResult result) {
+    if ((int)result < 0 || result > BOOKSPACE_ERROR) {
+        return "Unknown result.";
+    }
+    return RESULT_MESSAGES[result];
+}
+
+BookspaceResult bookspace_open(const DatabaseConfig* config, Bookspace** out) {
+    return initialize_database(config, out) == 0 ? BOOKSPACE_OK : BOOKSPACE_ERROR;
+}
+
+void bookspace_close(Bookspace* bs) {
+    close_database(bs);
+}
+
+// A validated BookingRequest in the storage encoding
+typedef struct {
+    int day;
+    int start_min;
+    int end_min;
+    int room;
+} Slot;
+
+// Date that can be viewed (this year up to five years ahead), -1 if invalid
+static int parse_date(const char* date) {
+    if (!date || !validate_date_for_viewing(date)) {
+        return -1;
+    }
+    return date_to_day_number(date);
+}
+
+static BookspaceResult parse_range(const char* date, const char* start_time, const char* end_time, Slot* slot) {
+    slot->day = parse_date(date);
+    if (slot->day < 0) return BOOKSPACE_INVALID_DATE;
+
+    slot->start_min = start_time ? time_to_minutes(start_time) : -1;
+    slot->end_min = end_time ? time_to_minutes(end_time) : -1;
+    if (slot->start_min < 0 || slot->end_min < 0) return BOOKSPACE_INVALID_TIME;
+    if (slot->start_min < LIBRARY_OPEN_MINUTES || slot->start_min >= LIBRARY_CLOSE_MINUTES ||
+        slot->end_min > LIBRARY_CLOSE_MINUTES) {
+        return BOOKSPACE_OUTSIDE_HOURS;
+    }
+    if (slot->end_min <= slot->start_min) return BOOKSPACE_BAD_RANGE;
+    return BOOKSPACE_OK;
+}
+
+static BookspaceResult parse_request(Bookspace* bs, const BookingRequest* request, Slot* slot) {
+    if (!request->name || !validate_student_name(request->name)) return BOOKSPACE_INVALID_NAME;
+    if (!request->student_num || !validate_student_num(request->student_num)) return BOOKSPACE_INVALID_STUDENT_NUM;
+
+    BookspaceResult result = parse_range(request->date, request->start_time, request->end_time, slot);
+    if (result != BOOKSPACE_OK) return result;
+    if (slot->day < today_day_number()) return BOOKSPACE_PAST_DATE;
+
+    slot->room = request->consultation_room ? find_room(bs, request->consultation_room) : -1;
+    if (slot->room < 0) return BOOKSPACE_UNKNOWN_ROOM;
+
+    const Room* room = room_at(bs, slot->room);
+    if (slot->start_min < room->open_min || slot->end_min > room->close_min) return BOOKSPACE_OUTSIDE_HOURS;
+    return BOOKSPACE_OK;
+}
+
+BookspaceResult bookspace_validate(Bookspace* bs, const BookingRequest* request) {
+    Slot slot;
+    return parse_request(bs, request, &slot);
+}
+
+int bookspace_room_count(Bookspace* bs) {
+    return room_count(bs);
+}
+
+const Room* bookspace_room(Bookspace* bs, int index) {
+    return room_at(bs, index);
+}
+
+int bookspace_find_room(Bookspace* bs, const char* name) {
+    return name ? find_room(bs, name) : -1;
+}
+
+BookspaceResult bookspace_add_room(Bookspace* bs, const char* name, int capacity, const char* open_time,
+                                   const char* close_time, int* index_out) {
+    size_t length = name ? strlen(name) : 0;
+    if (length == 0 || length >= MAX_ROOM_LENGTH || capacity < 1) return BOOKSPACE_INVALID_ROOM;
+
+    int open_min = open_time ? time_to_minutes(open_time) : LIBRARY_OPEN_MINUTES;
+    int close_min = close_time ? time_to_minutes(close_time) : LIBRARY_CLOSE_MINUTES;
+    if (open_min < 0 || close_min < 0) return BOOKSPACE_INVALID_TIME;
+    if (open_min < LIBRARY_OPEN_MINUTES || close_min > LIBRARY_CLOSE_MINUTES) return BOOKSPACE_OUTSIDE_HOURS;
+    if (close_min <= open_min) return BOOKSPACE_BAD_RANGE;
+
+    return insert_room(bs, name, capacity, open_min, close_min, index_out);
+}
+
+static BookspaceResult book(Bookspace* bs, const BookingRequest* request, char* id_out, size_t id_size) {
+    Slot slot;
+    BookspaceResult result = parse_request(bs, request, &slot);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+
+    char reservation_id[MAX_RESERVATION_ID_LENGTH];
+    if (request->reservation_id && request->reservation_id[0] != '\0') {
+        if (strlen(request->reservation_id) >= sizeof(reservation_id)) return BOOKSPACE_INVALID_ID;
+        strcpy(reservation_id, request->reservation_id);
+    } else {
+        generate_reservation_id(reservation_id, sizeof(reservation_id), request->date);
+    }
+
+    result = insert_reservation_slot(bs, request->name, request->student_num, slot.day, slot.start_min, slot.end_min,
+                                     reservation_id, slot.room);
+    if (result == BOOKSPACE_OK && id_out && id_size > 0) {
+        snprintf(id_out, id_size, "%s", reservation_id);
+    }
+    return result;
+}
+
+BookspaceResult bookspace_book(Bookspace* bs, const BookingRequest* request, char* id_out, size_t id_size) {
+    long long started = stats_start();
+    BookspaceResult result = book(bs, request, id_out, id_size);
+    stats_finish(STATS_OP_BOOK, started);
+    return result;
+}
+
+BookspaceResult bookspace_cancel(Bookspace* bs, const char* reservation_id) {
+    long long started = stats_start();
+    BookspaceResult result = delete_reservation(bs, reservation_id);
+    stats_finish(STATS_OP_CANCEL, started);
+    return result;
+}
+
+static BookspaceResult edit(Bookspace* bs, const char* reservation_id, const BookingRequest* request) {
+    Slot slot;
+    BookspaceResult result = parse_request(bs, request, &slot);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+    return update_reservation_slot(bs, reservation_id, request->name, request->student_num,
+                                   slot.day, slot.start_min, slot.end_min, slot.room);
+}
+
+BookspaceResult bookspace_edit(Bookspace* bs, const char* reservation_id, const BookingRequest* request) {
+    long long started = stats_start();
+    BookspaceResult result = edit(bs, reservation_id, request);
+    stats_finish(STATS_OP_EDIT, started);
+    return result;
+}
+
+BookspaceResult bookspace_stats_write(FILE* out, StatsFormat format) {
+    return stats_write(out, format) == 0 ? BOOKSPACE_OK : BOOKSPACE_ERROR;
+}
+
+BookspaceResult bookspace_begin_group(Bookspace* bs) {
+    return begin_batch(bs) == 0 ? BOOKSPACE_OK : BOOKSPACE_BUSY;
+}
+
+BookspaceResult bookspace_commit_group(Bookspace* bs) {
+    return commit_batch(bs) == 0 ? BOOKSPACE_OK : BOOKSPACE_ERROR;
+}
+
+BookspaceResult bookspace_get(Bookspace* bs, const char* reservation_id, Reservation* out) {
+    ReservationCursor cursor;
+    if (reservation_cursor_by_id(bs, &cursor, reservation_id) != 0) {
+        return BOOKSPACE_ERROR;
+    }
+    int rc = reservation_cursor_read(&cursor, out);
+    reservation_cursor_close(&cursor);
+    if (rc < 0) return BOOKSPACE_ERROR;
+    return rc == 1 ? BOOKSPACE_OK : BOOKSPACE_NOT_FOUND;
+}
+
+BookspaceResult bookspace_room_available(Bookspace* bs, const char* date, const char* start_time, const char* end_time,
+                                         const char* consultation_room, int* available) {
+    Slot slot;
+    BookspaceResult result = parse_range(date, start_time, end_time, &slot);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+    int room = consultation_room ? find_room(bs, consultation_room) : -1;
+    if (room < 0) {
+        return BOOKSPACE_UNKNOWN_ROOM;
+    }
+    const Room* info = room_at(bs, room);
+    if (slot.start_min < info->open_min || slot.end_min > info->close_min) {
+        *available = 0; // closed for part of the range
+        return BOOKSPACE_OK;
+    }
+
+    // Exact interval check: the slot bitmaps round partly used 5-minute slots up to busy
+    int free = slot_available(bs, slot.day, slot.start_min, slot.end_min, room);
+    if (free < 0) {
+        return BOOKSPACE_ERROR;
+    }
+    *available = free;
+    return BOOKSPACE_OK;
+}
+
+BookspaceResult bookspace_free_rooms(Bookspace* bs, const char* date, const char* start_time, const char* end_time,
+                                     int* rooms_out, int* count) {
+    Slot slot;
+    BookspaceResult result = parse_range(date, start_time, end_time, &slot);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+    int found = free_rooms(bs, slot.day, slot.start_min, slot.end_min, rooms_out);
+    if (found < 0) {
+        return BOOKSPACE_ERROR;
+    }
+    *count = found;
+    return BOOKSPACE_OK;
+}
+
+BookspaceResult bookspace_next_free(Bookspace* bs, const char* date, const char* from_time, int duration_min,
+                                    const char* consultation_room, int* start_min, int* room_out) {
+    int day = parse_date(date);
+    if (day < 0) {
+        return BOOKSPACE_INVALID_DATE;
+    }
+    int from_min = from_time ? time_to_minutes(from_time) : LIBRARY_OPEN_MINUTES;
+    if (from_min < 0) {
+        return BOOKSPACE_INVALID_TIME;
+    }
+    if (duration_min <= 0 || duration_min > LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES) {
+        return BOOKSPACE_BAD_RANGE;
+    }
+
+    int room = -1;
+    if (consultation_room) {
+        room = find_room(bs, consultation_room);
+        if (room < 0) {
+            return BOOKSPACE_UNKNOWN_ROOM;
+        }
+    }
+
+    int start = first_free_window(bs, day, from_min, duration_min, room, room_out);
+    if (start < -1) {
+        return BOOKSPACE_ERROR;
+    }
+    *start_min = start;
+    return BOOKSPACE_OK;
+}
+
+static int compare_gaps(const void* a, const void* b) {
+    const FreeGap* x = a;
+    const FreeGap* y = b;
+    if (x->day != y->day) return x->day < y->day ? -1 : 1;
+    if (x->start_min != y->start_min) return x->start_min < y->start_min ? -1 : 1;
+    return (x->room > y->room) - (x->room < y->room);
+}
+
+BookspaceResult bookspace_find_free_slots(Bookspace* bs, const char* date, const char* from_time, int duration_min,
+                                          const char* consultation_room, int horizon_days, FreeGap* gaps_out,
+                                          int max_gaps, int* count) {
+    int first_day = parse_date(date);
+    if (first_day < 0) {
+        return BOOKSPACE_INVALID_DATE;
+    }
+    if (first_day < today_day_number()) {
+        return BOOKSPACE_PAST_DATE;
+    }
+    int from_min = from_time ? time_to_minutes(from_time) : LIBRARY_OPEN_MINUTES;
+    if (from_min < 0) {
+        return BOOKSPACE_INVALID_TIME;
+    }
+    if (duration_min <= 0 || duration_min > LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES ||
+        horizon_days < 1 || horizon_days > FREE_SLOT_MAX_HORIZON || max_gaps < 1) {
+        return BOOKSPACE_BAD_RANGE;
+    }
+    int last_day = first_day + horizon_days - 1;
+
+    if (consultation_room) {
+        int room = find_room(bs, consultation_room);
+        if (room < 0) {
+            return BOOKSPACE_UNKNOWN_ROOM;
+        }
+        int found = room_free_gaps(bs, room, first_day, from_min, last_day, duration_min, gaps_out, max_gaps);
+        if (found < 0) {
+            return BOOKSPACE_ERROR;
+        }
+        *count = found;
+        return BOOKSPACE_OK;
+    }
+
+    // Any room: each room's scan yields its own earliest gaps, which are merged into the
+    // best max_gaps so far. Once max_gaps are held, later rooms only scan up to the day of
+    // the last of them, since nothing after it can make the cut.
+    int rooms = room_count(bs);
+    FreeGap* merged = malloc((size_t)max_gaps * 2 * sizeof(*merged));
+    if (!merged) {
+        return BOOKSPACE_ERROR;
+    }
+    int held = 0;
+    for (int room = 0; room < rooms; room++) {
+        int found = room_free_gaps(bs, room, first_day, from_min, last_day, duration_min, merged + held, max_gaps);
+        if (found < 0) {
+            free(merged);
+            return BOOKSPACE_ERROR;
+        }
+        held += found;
+        qsort(merged, (size_t)held, sizeof(*merged), compare_gaps);
+        if (held >= max_gaps) {
+            held = max_gaps;
+            last_day = merged[held - 1].day;
+        }
+    }
+    memcpy(gaps_out, merged, (size_t)held * sizeof(*merged));
+    free(merged);
+    *count = held;
+    return BOOKSPACE_OK;
+}
+
+BookspaceResult bookspace_availability_grid(Bookspace* bs, const char* date, int days, const char* const* rooms,
+                                            int room_count, int step_min, AvailabilityGrid* grid) {
+    memset(grid, 0, sizeof(*grid));
+    int first_day = parse_date(date);
+    if (first_day < 0) {
+        return BOOKSPACE_INVALID_DATE;
+    }
+    if (days < 1 || days > GRID_MAX_DAYS || step_min < SLOT_MINUTES || step_min % SLOT_MINUTES != 0 ||
+        step_min > LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES) {
+        return BOOKSPACE_BAD_RANGE;
+    }
+
+    if (!rooms) {
+        room_count = bookspace_room_count(bs);
+    }
+    if (room_count < 1) {
+        return BOOKSPACE_UNKNOWN_ROOM;
+    }
+    grid->rooms = malloc((size_t)room_count * sizeof(*grid->rooms));
+    if (!grid->rooms) {
+        return BOOKSPACE_ERROR;
+    }
+    for (int i = 0; i < room_count; i++) {
+        grid->rooms[i] = rooms ? find_room(bs, rooms[i]) : i;
+        if (grid->rooms[i] < 0) {
+            bookspace_grid_free(grid);
+            return BOOKSPACE_UNKNOWN_ROOM;
+        }
+    }
+
+    grid->first_day = first_day;
+    grid->days = days;
+    grid->room_count = room_count;
+    grid->step_min = step_min;
+    grid->cells_per_day = (LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES + step_min - 1) / step_min;
+    size_t day_cells = (size_t)room_count * grid->cells_per_day;
+    grid->cells = malloc((size_t)days * day_cells);
+    if (!grid->cells) {
+        bookspace_grid_free(grid);
+        return BOOKSPACE_ERROR;
+    }
+
+    for (int d = 0; d < days; d++) {
+        if (availability_grid_day(bs, first_day + d, grid->rooms, room_count, step_min, grid->cells + d * day_cells) != 0) {
+            bookspace_grid_free(grid);
+            return BOOKSPACE_ERROR;
+        }
+    }
+    return BOOKSPACE_OK;
+}
+
+void bookspace_grid_free(AvailabilityGrid* grid) {
+    free(grid->rooms);
+    free(grid->cells);
+    grid->rooms = NULL;
+    grid->cells = NULL;
+}
@@ -0,0 +1,1015 @@
+#include "headers/cli.h"
+#include "headers/bookspace.h"
+#include "headers/reservation.h"
+#include "headers/availability.h"
+#include "headers/table.h"
+#include "headers/main.h"
+#include "headers/server.h"
+#include "headers/stats.h"
+#include "headers/import.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <ctype.h>
+
+// Write commands print "ok<TAB>id"; failures print "error<TAB>name<TAB>message" on stderr,
+// where name is bookspace_result_name() and stays stable across releases.
+
+typedef struct {
+    const char* name;
+    const char* student_num;
+    const char* date;
+    const char* start_time;
+    const char* end_time;
+    const char* room;
+    const char* reservation_id;
+    const char* from_time;
+    const char* duration;
+    const char* capacity;
+    const char* open_time;
+    const char* close_time;
+    const char* days;
+    const char* rooms;
+    const char* step;
+    const char* count;
+    const char* horizon;
+    const char* format;
+    const char* out;
+    const char* batch;
+    const char* positional;
+} CliOptions;
+
+typedef struct {
+    const char* flag;
+    size_t offset;
+} CliFlag;
+
+static const CliFlag FLAGS[] = {
+    { "--name", offsetof(CliOptions, name) },
+    { "--student", offsetof(CliOptions, student_num) },
+    { "--date", offsetof(CliOptions, date) },
+    { "--start", offsetof(CliOptions, start_time) },
+    { "--end", offsetof(CliOptions, end_time) },
+    { "--room", offsetof(CliOptions, room) },
+    { "--id", offsetof(CliOptions, reservation_id) },
+    { "--from", offsetof(CliOptions, from_time) },
+    { "--duration", offsetof(CliOptions, duration) },
+    { "--capacity", offsetof(CliOptions, capacity) },
+    { "--open", offsetof(CliOptions, open_time) },
+    { "--close", offsetof(CliOptions, close_time) },
+    { "--days", offsetof(CliOptions, days) },
+    { "--rooms", offsetof(CliOptions, rooms) },
+    { "--step", offsetof(CliOptions, step) },
+    { "--count", offsetof(CliOptions, count) },
+    { "--horizon", offsetof(CliOptions, horizon) },
+    { "--format", offsetof(CliOptions, format) },
+    { "--out", offsetof(CliOptions, out) },
+    { "--batch", offsetof(CliOptions, batch) }
+};
+#define NUM_FLAGS (sizeof(FLAGS) / sizeof(FLAGS[0]))
+
+typedef int (*CliHandler)(CliSession* cli, const CliOptions* opts);
+
+typedef struct {
+    const char* name;
+    CliHandler run;
+    const char* usage;
+    int own_format;  // 1 = --format names the command's own output, not tsv/json/table
+    int writes;      // 1 = changes the database (the daemon runs it on the writer)
+} CliCommand;
+
+// Large enough for a semester of rows, so keep it out of the stack;
+// one per thread because daemon reader threads render tables concurrently
+static _Thread_local TableRenderer cli_table;
+
+//OUTPUT HELPERS
+
+static void write_json_string(FILE* out, const char* str) {
+    putc('"', out);
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            putc('\\', out);
+            putc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            putc(c, out);
+        }
+    }
+    putc('"', out);
+}
+
+// Failure record on the error stream; script runs prefix the line number like the importer
+static int report(CliSession* cli, int status, const char* name, const char* message) {
+    cli->replied = 1;
+    if (cli->line_no > 0) {
+        fprintf(cli->err, "line %ld: ", cli->line_no);
+    }
+    if (cli->format == FORMAT_JSON) {
+        fputs("{\"error\":", cli->err);
+        write_json_string(cli->err, name);
+        fputs(",\"message\":", cli->err);
+        write_json_string(cli->err, message);
+        fputs("}\n", cli->err);
+    } else if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->err, "Error: %s\n", message);
+    } else {
+        fprintf(cli->err, "error\t%s\t%s\n", name, message);
+    }
+    return status;
+}
+
+static int report_result(CliSession* cli, BookspaceResult result) {
+    return report(cli, CLI_FAILED, bookspace_result_name(result), bookspace_result_message(result));
+}
+
+static int report_usage(CliSession* cli, const char* message) {
+    return report(cli, CLI_USAGE, "usage", message);
+}
+
+// Success record for book/cancel
+static void write_ok(CliSession* cli, const char* action, const char* reservation_id) {
+    cli->replied = 1;
+    if (cli->format == FORMAT_JSON) {
+        fputs("{\"result\":\"ok\",\"action\":", cli->out);
+        write_json_string(cli->out, action);
+        fputs(",\"reservation_id\":", cli->out);
+        write_json_string(cli->out, reservation_id);
+        fputs("}\n", cli->out);
+    } else if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "Reservation '%s' %s.\n", reservation_id, action);
+    } else {
+        fprintf(cli->out, "ok\t%s\n", reservation_id);
+    }
+}
+
+// ReservationVisitor for the tsv and json formats; dates MM/DD/YYYY, times 24-hour HH:MM
+static int write_row(const ReservationRow* row, void* data) {
+    CliSession* cli = data;
+    char date[MAX_DATE_LENGTH];
+    char start[MAX_TIME_LENGTH];
+    char end[MAX_TIME_LENGTH];
+    day_number_to_date(row->day, date);
+    minutes_to_time_24hour(row->start_min, start);
+    minutes_to_time_24hour(row->end_min, end);
+
+    if (cli->format == FORMAT_JSON) {
+        fputs("{\"reservation_id\":", cli->out);
+        write_json_string(cli->out, row->reservation_id);
+        fprintf(cli->out, ",\"date\":\"%s\",\"room\":", date);
+        write_json_string(cli->out, row->consultation_room);
+        fprintf(cli->out, ",\"start\":\"%s\",\"end\":\"%s\",\"name\":", start, end);
+        write_json_string(cli->out, row->name);
+        fputs(",\"student_num\":", cli->out);
+        write_json_string(cli->out, row->student_num);
+        fputs("}\n", cli->out);
+    } else {
+        fprintf(cli->out, "%s\t%s\t%s\t%s\t%s\t%s\t%s\n", row->reservation_id, date, row->consultation_room,
+                start, end, row->name, row->student_num);
+    }
+    return 0;
+}
+
+// Visitor state for write_rows: the row count decides the table's empty message
+typedef struct {
+    CliSession* cli;
+    long rows;
+} RowWriter;
+
+static int write_counted_row(const ReservationRow* row, void* data) {
+    RowWriter* writer = data;
+    writer->rows++;
+    if (writer->cli->format == FORMAT_TABLE) {
+        return table_row(row, &cli_table);
+    }
+    return write_row(row, writer->cli);
+}
+
+// for_each_reservation returns 0 on success (with or without rows) and 1 on error
+static int write_rows(CliSession* cli, ReservationCursor* cursor) {
+    RowWriter writer = { cli, 0 };
+    if (cli->format == FORMAT_TABLE) {
+        table_init(&cli_table, cli->out);
+        table_border(&cli_table);
+        table_header(&cli_table, "Start Time", "End Time");
+        table_border(&cli_table);
+    }
+
+    int rc = for_each_reservation(cursor, write_counted_row, &writer);
+
+    if (cli->format == FORMAT_TABLE) {
+        if (rc == 0 && writer.rows == 0) {
+            table_message(&cli_table, "No reservations found.");
+        }
+        table_border(&cli_table);
+        table_flush(&cli_table);
+    }
+    return rc != 0 ? report_result(cli, BOOKSPACE_ERROR) : CLI_OK;
+}
+
+// Whole number in 1..max, 0 if text is anything else
+static long parse_positive(const char* text, long max) {
+    char* end;
+    long value = strtol(text, &end, 10);
+    return (*text != '\0' && *end == '\0' && value >= 1 && value <= max) ? value : 0;
+}
+
+#define CLI_STR_(x) #x
+#define CLI_STR(x) CLI_STR_(x) // a limit macro as a string literal, for usage messages
+
+// Whole number in min..max into *value; 1 (value untouched) if text is anything else
+static int parse_bounded(const char* text, long min, long max, long* value) {
+    char* end;
+    long parsed = strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || parsed < min || parsed > max) {
+        return 1;
+    }
+    *value = parsed;
+    return 0;
+}
+
+//COMMANDS
+
+static int run_book(CliSession* cli, const CliOptions* opts) {
+    if (!opts->name || !opts->student_num || !opts->date || !opts->start_time || !opts->end_time || !opts->room) {
+        return report_usage(cli, "book needs --name, --student, --date, --start, --end and --room");
+    }
+
+    BookingRequest request = { opts->name, opts->student_num, opts->date, opts->start_time, opts->end_time,
+                               opts->room, opts->reservation_id };
+    char reservation_id[MAX_RESERVATION_ID_LENGTH];
+    BookspaceResult result = bookspace_book(cli->bs, &request, reservation_id, sizeof(reservation_id));
+    if (result != BOOKSPACE_OK) {
+        return report_result(cli, result);
+    }
+    write_ok(cli, "created", reservation_id);
+    return CLI_OK;
+}
+
+static int run_cancel(CliSession* cli, const CliOptions* opts) {
+    const char* reservation_id = opts->reservation_id ? opts->reservation_id : opts->positional;
+    if (!reservation_id) {
+        return report_usage(cli, "cancel needs a reservation ID (--id ID)");
+    }
+
+    BookspaceResult result = bookspace_cancel(cli->bs, reservation_id);
+    if (result != BOOKSPACE_OK) {
+        return report_result(cli, result);
+    }
+    write_ok(cli, "cancelled", reservation_id);
+    return CLI_OK;
+}
+
+static int run_list(CliSession* cli, const CliOptions* opts) {
+    ReservationCursor cursor;
+    const char* date = opts->date ? opts->date : opts->positional;
+    if (date) {
+        if (!validate_date_for_viewing(date)) {
+            return report_result(cli, BOOKSPACE_INVALID_DATE);
+        }
+        if (reservation_cursor_by_date(cli->bs, &cursor, date) != 0) {
+            return report_result(cli, BOOKSPACE_ERROR);
+        }
+    } else if (reservation_cursor_all(cli->bs, &cursor) != 0) {
+        return report_result(cli, BOOKSPACE_ERROR);
+    }
+    return write_rows(cli, &cursor);
+}
+
+static int run_search(CliSession* cli, const CliOptions* opts) {
+    ReservationCursor cursor;
+    const char* name = opts->name ? opts->name : opts->positional;
+    int rc;
+    if (opts->reservation_id) {
+        rc = reservation_cursor_by_id(cli->bs, &cursor, opts->reservation_id);
+    } else if (opts->student_num) {
+        rc = reservation_cursor_by_student_num(cli->bs, &cursor, opts->student_num);
+    } else if (name) {
+        rc = reservation_cursor_by_name(cli->bs, &cursor, name); // partial match
+    } else {
+        return report_usage(cli, "search needs --name TEXT, --student NUM or --id ID");
+    }
+    if (rc != 0) {
+        return report_result(cli, BOOKSPACE_ERROR);
+    }
+    return write_rows(cli, &cursor);
+}
+
+static void write_room_state(CliSession* cli, const char* room, int free) {
+    if (cli->format == FORMAT_JSON) {
+        fputs("{\"room\":", cli->out);
+        write_json_string(cli->out, room);
+        fprintf(cli->out, ",\"free\":%s}\n", free ? "true" : "false");
+    } else if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "%-15s %s\n", room, free ? "Available" : "Booked");
+    } else {
+        fprintf(cli->out, "%s\t%s\n", room, free ? "free" : "busy");
+    }
+}
+
+// Earliest free window of --duration minutes at or after --from
+static int run_next_free(CliSession* cli, const CliOptions* opts) {
+    long duration = parse_positive(opts->duration, 24 * 60);
+    if (!duration) {
+        return report_usage(cli, "--duration must be a positive number of minutes");
+    }
+
+    int start_min = -1, room = -1;
+    BookspaceResult result = bookspace_next_free(cli->bs, opts->date, opts->from_time, (int)duration, opts->room,
+                                                 &start_min, &room);
+    if (result != BOOKSPACE_OK) {
+        return report_result(cli, result);
+    }
+
+    char start[MAX_TIME_LENGTH], finish[MAX_TIME_LENGTH];
+    if (start_min >= 0) {
+        minutes_to_time_24hour(start_min, start);
+        minutes_to_time_24hour(start_min + (int)duration, finish);
+    }
+    if (cli->format == FORMAT_JSON) {
+        if (start_min < 0) {
+            fputs("{\"room\":null}\n", cli->out);
+        } else {
+            fputs("{\"room\":", cli->out);
+            write_json_string(cli->out, bookspace_room(cli->bs, room)->name);
+            fprintf(cli->out, ",\"start\":\"%s\",\"end\":\"%s\"}\n", start, finish);
+        }
+    } else if (cli->format == FORMAT_TABLE) {
+        if (start_min < 0) {
+            fprintf(cli->out, "No free window on %s.\n", opts->date);
+        } else {
+            fprintf(cli->out, "%s is free from %s to %s.\n", bookspace_room(cli->bs, room)->name, start, finish);
+        }
+    } else {
+        if (start_min < 0) {
+            fputs("none\n", cli->out);
+        } else {
+            fprintf(cli->out, "%s\t%s\t%s\n", bookspace_room(cli->bs, room)->name, start, finish);
+        }
+    }
+    return CLI_OK;
+}
+
+static int run_avail(CliSession* cli, const CliOptions* opts) {
+    if (!opts->date) {
+        return report_usage(cli, "avail needs --date");
+    }
+    if (opts->duration) {
+        return run_next_free(cli, opts);
+    }
+    if (!opts->start_time || !opts->end_time) {
+        return report_usage(cli, "avail needs --start and --end, or --duration");
+    }
+
+    BookspaceResult result;
+    if (opts->room) {
+        int available = 0;
+        result = bookspace_room_available(cli->bs, opts->date, opts->start_time, opts->end_time, opts->room, &available);
+        if (result != BOOKSPACE_OK) {
+            return report_result(cli, result);
+        }
+        write_room_state(cli, opts->room, available);
+        return CLI_OK;
+    }
+
+    int room_count = bookspace_room_count(cli->bs);
+    int* rooms = malloc(((size_t)room_count + 1) * sizeof(*rooms));
+    int count = 0;
+    if (!rooms) {
+        return report_result(cli, BOOKSPACE_ERROR);
+    }
+    result = bookspace_free_rooms(cli->bs, opts->date, opts->start_time, opts->end_time, rooms, &count);
+    if (result != BOOKSPACE_OK) {
+        free(rooms);
+        return report_result(cli, result);
+    }
+    // Free rooms come back in index order, so one pass pairs them up
+    for (int r = 0, i = 0; r < room_count; r++) {
+        int room_free = i < count && rooms[i] == r;
+        if (room_free) i++;
+        write_room_state(cli, bookspace_room(cli->bs, r)->name, room_free);
+    }
+    free(rooms);
+    return CLI_OK;
+}
+
+// The room catalog, in id order
+static int run_rooms(CliSession* cli, const CliOptions* opts) {
+    (void)opts;
+    int count = bookspace_room_count(cli->bs);
+    if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "%-4s %-20s %-8s %-6s %s\n", "ID", "Room", "Capacity", "Opens", "Closes");
+    }
+    for (int i = 0; i < count; i++) {
+        const Room* room = bookspace_room(cli->bs, i);
+        char open[MAX_TIME_LENGTH], close[MAX_TIME_LENGTH];
+        minutes_to_time_24hour(room->open_min, open);
+        minutes_to_time_24hour(room->close_min, close);
+
+        if (cli->format == FORMAT_JSON) {
+            fprintf(cli->out, "{\"id\":%d,\"name\":", room->id);
+            write_json_string(cli->out, room->name);
+            fprintf(cli->out, ",\"capacity\":%d,\"open\":\"%s\",\"close\":\"%s\"}\n", room->capacity, open, close);
+        } else if (cli->format == FORMAT_TABLE) {
+            fprintf(cli->out, "%-4d %-20s %-8d %-6s %s\n", room->id, room->name, room->capacity, open, close);
+        } else {
+            fprintf(cli->out, "%d\t%s\t%d\t%s\t%s\n", room->id, room->name, room->capacity, open, close);
+        }
+    }
+    return CLI_OK;
+}
+
+static int run_addroom(CliSession* cli, const CliOptions* opts) {
+    const char* name = opts->name ? opts->name : opts->positional;
+    if (!name) {
+        return report_usage(cli, "addroom needs --name NAME");
+    }
+    long capacity = opts->capacity ? parse_positive(opts->capacity, 100000) : 1;
+    if (!capacity) {
+        return report_usage(cli, "--capacity must be a positive number of seats");
+    }
+
+    int index = -1;
+    BookspaceResult result = bookspace_add_room(cli->bs, name, (int)capacity, opts->open_time, opts->close_time, &index);
+    if (result != BOOKSPACE_OK) {
+        return report_result(cli, result);
+    }
+
+    const Room* room = bookspace_room(cli->bs, index);
+    cli->replied = 1;
+    if (cli->format == FORMAT_JSON) {
+        fprintf(cli->out, "{\"result\":\"ok\",\"action\":\"created\",\"room_id\":%d,\"name\":", room->id);
+        write_json_string(cli->out, room->name);
+        fputs("}\n", cli->out);
+    } else if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "Room '%s' added with ID %d.\n", room->name, room->id);
+    } else {
+        fprintf(cli->out, "ok\t%d\n", room->id);
+    }
+    return CLI_OK;
+}
+
+static int run_import(CliSession* cli, const CliOptions* opts) {
+    if (cli->protocol) {
+        // The file would be opened by the daemon, with its privileges and inside its write group
+        return report_usage(cli, "import runs locally; use --db instead of --connect");
+    }
+    const char* path = opts->positional;
+    if (!path) {
+        return report_usage(cli, "import needs a CSV/TSV file or - for stdin");
+    }
+    long batch_size = opts->batch ? parse_positive(opts->batch, 1000000) : IMPORT_DEFAULT_BATCH;
+    if (!batch_size) {
+        return report_usage(cli, "--batch must be a number of rows from 1 to 1000000");
+    }
+
+    FILE* in = strcmp(path, "-") == 0 ? stdin : fopen(path, "r");
+    if (!in) {
+        return report(cli, CLI_FAILED, "error", "cannot open the import file");
+    }
+    ImportStats stats;
+    int rc = import_reservations(cli->bs, in, (int)batch_size, cli->err, &stats);
+    if (in != stdin) {
+        fclose(in);
+    }
+    if (rc != 0) {
+        return report_result(cli, BOOKSPACE_ERROR);
+    }
+
+    cli->replied = 1;
+    if (cli->format == FORMAT_JSON) {
+        fprintf(cli->out, "{\"result\":\"ok\",\"action\":\"imported\",\"rows\":%ld,\"imported\":%ld,\"rejected\":%ld}\n",
+                stats.rows, stats.imported, stats.rejected);
+    } else if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "Import finished: %ld rows, %ld imported, %ld rejected.\n",
+                stats.rows, stats.imported, stats.rejected);
+    } else {
+        fprintf(cli->out, "ok\t%ld\t%ld\t%ld\n", stats.rows, stats.imported, stats.rejected);
+    }
+    return CLI_OK;
+}
+
+// Day 0 (01/01/1970) was a Thursday
+static const char* WEEKDAYS[] = { "Thursday", "Friday", "Saturday", "Sunday", "Monday", "Tuesday", "Wednesday" };
+
+#define CLI_MAX_GAPS 100
+
+// First --count free gaps of --duration minutes from --date/--from, within --horizon days
+static int run_next(CliSession* cli, const CliOptions* opts) {
+    if (!opts->date || !opts->duration) {
+        return report_usage(cli, "next needs --date and --duration");
+    }
+    long duration = parse_positive(opts->duration, 24 * 60);
+    long count = opts->count ? parse_positive(opts->count, CLI_MAX_GAPS) : 5;
+    long horizon = opts->horizon ? parse_positive(opts->horizon, FREE_SLOT_MAX_HORIZON) : 14;
+    if (!duration) {
+        return report_usage(cli, "--duration must be a positive number of minutes");
+    }
+    if (!count) {
+        return report_usage(cli, "--count must be between 1 and 100");
+    }
+    if (!horizon) {
+        return report_usage(cli, "--horizon must be between 1 and 366 days");
+    }
+
+    FreeGap gaps[CLI_MAX_GAPS];
+    int found = 0;
+    BookspaceResult result = bookspace_find_free_slots(cli->bs, opts->date, opts->from_time, (int)duration, opts->room,
+                                                       (int)horizon, gaps, (int)count, &found);
+    if (result != BOOKSPACE_OK) {
+        return report_result(cli, result);
+    }
+
+    if (found == 0 && cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "No free %ld-minute slot within %ld days.\n", duration, horizon);
+    }
+    for (int i = 0; i < found; i++) {
+        char date[MAX_DATE_LENGTH], start[MAX_TIME_LENGTH], end[MAX_TIME_LENGTH], until[MAX_TIME_LENGTH];
+        day_number_to_date(gaps[i].day, date);
+        minutes_to_time_24hour(gaps[i].start_min, start);
+        minutes_to_time_24hour(gaps[i].start_min + (int)duration, end);
+        minutes_to_time_24hour(gaps[i].end_min, until);
+        const char* room = bookspace_room(cli->bs, gaps[i].room)->name;
+
+        if (cli->format == FORMAT_JSON) {
+            fprintf(cli->out, "{\"date\":\"%s\",\"room\":", date);
+            write_json_string(cli->out, room);
+            fprintf(cli->out, ",\"start\":\"%s\",\"end\":\"%s\",\"free_until\":\"%s\"}\n", start, end, until);
+        } else if (cli->format == FORMAT_TABLE) {
+            fprintf(cli->out, "%s %-9s %-20s %s - %s   (free until %s)\n", date, WEEKDAYS[gaps[i].day % 7], room,
+                    start, end, until);
+        } else {
+            fprintf(cli->out, "%s\t%s\t%s\t%s\t%s\n", date, room, start, end, until);
+        }
+    }
+    return CLI_OK;
+}
+
+// One row block per day: a time ruler, then a line of cells per room
+static void write_grid_table(CliSession* cli, const AvailabilityGrid* grid) {
+    char ruler[SLOTS_PER_DAY + 3];
+    memset(ruler, ' ', sizeof(ruler));
+    int next = 0;
+    for (int c = 0; c < grid->cells_per_day; c++) {
+        int minute = LIBRARY_OPEN_MINUTES + c * grid->step_min;
+        if (minute % 60 == 0 && c >= next) {
+            ruler[c] = (char)('0' + minute / 600);
+            ruler[c + 1] = (char)('0' + minute / 60 % 10);
+            next = c + 3; // keep a space between labels
+        }
+    }
+    int width = next - 1 > grid->cells_per_day ? next - 1 : grid->cells_per_day; // a label may overhang
+
+    for (int d = 0; d < grid->days; d++) {
+        char date[MAX_DATE_LENGTH];
+        day_number_to_date(grid->first_day + d, date);
+        fprintf(cli->out, "%s %-9s %.*s\n", date, WEEKDAYS[(grid->first_day + d) % 7], width, ruler);
+        for (int r = 0; r < grid->room_count; r++) {
+            const char* row = grid->cells + ((size_t)d * grid->room_count + r) * grid->cells_per_day;
+            fprintf(cli->out, "%-20.20s %.*s\n", bookspace_room(cli->bs, grid->rooms[r])->name, grid->cells_per_day, row);
+        }
+        fputc('\n', cli->out);
+    }
+    fprintf(cli->out, "%c free   %c booked   %c closed   (%d minutes per cell)\n", GRID_FREE, GRID_BUSY, GRID_CLOSED,
+            grid->step_min);
+}
+
+// JSON row: the cells plus the free runs as start/end pairs
+static void write_grid_json_row(CliSession* cli, const char* date, const char* room, const char* row,
+                                const AvailabilityGrid* grid) {
+    fprintf(cli->out, "{\"date\":\"%s\",\"room\":", date);
+    write_json_string(cli->out, room);
+    fprintf(cli->out, ",\"step\":%d,\"cells\":\"%.*s\",\"free\":[", grid->step_min, grid->cells_per_day, row);
+    int first = 1;
+    for (int c = 0; c < grid->cells_per_day; ) {
+        if (row[c] != GRID_FREE) {
+            c++;
+            continue;
+        }
+        int run = c;
+        while (c < grid->cells_per_day && row[c] == GRID_FREE) c++;
+        int end_min = LIBRARY_OPEN_MINUTES + c * grid->step_min;
+        char start[MAX_TIME_LENGTH], end[MAX_TIME_LENGTH];
+        minutes_to_time_24hour(LIBRARY_OPEN_MINUTES + run * grid->step_min, start);
+        minutes_to_time_24hour(end_min < LIBRARY_CLOSE_MINUTES ? end_min : LIBRARY_CLOSE_MINUTES, end);
+        fprintf(cli->out, "%s[\"%s\",\"%s\"]", first ? "" : ",", start, end);
+        first = 0;
+    }
+    fputs("]}\n", cli->out);
+}
+
+// Free/busy grid for --days days from --date; --rooms is a comma-separated list of names
+static int run_grid(CliSession* cli, const CliOptions* opts) {
+    const char* date = opts->date ? opts->date : opts->positional;
+    if (!date) {
+        return report_usage(cli, "grid needs --date");
+    }
+    long days = opts->days ? parse_positive(opts->days, GRID_MAX_DAYS) : 7;
+    long step = opts->step ? parse_positive(opts->step, LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES) : 30;
+    if (!days) {
+        return report_usage(cli, "--days must be between 1 and 31");
+    }
+    if (!step || step % SLOT_MINUTES != 0) {
+        return report_usage(cli, "--step must be a multiple of 5 minutes");
+    }
+
+    char list[CLI_MAX_LINE];
+    const char* names[CLI_MAX_ARGS];
+    int name_count = 0;
+    if (opts->rooms) {
+        // Split in place by hand: strtok is not safe on the daemon's reader threads
+        snprintf(list, sizeof(list), "%s", opts->rooms);
+        char* name = list;
+        while (name && name_count < CLI_MAX_ARGS) {
+            char* comma = strchr(name, ',');
+            if (comma) *comma = '\0';
+            while (isspace((unsigned char)*name)) name++;
+            size_t len = strlen(name);
+            while (len > 0 && isspace((unsigned char)name[len - 1])) name[--len] = '\0';
+            if (len > 0) names[name_count++] = name;
+            name = comma ? comma + 1 : NULL;
+        }
+        if (name_count == 0) {
+            return report_usage(cli, "--rooms needs at least one room name");
+        }
+    }
+
+    AvailabilityGrid grid;
+    BookspaceResult result = bookspace_availability_grid(cli->bs, date, (int)days, opts->rooms ? names : NULL,
+                                                         name_count, (int)step, &grid);
+    if (result != BOOKSPACE_OK) {
+        return report_result(cli, result);
+    }
+
+    if (cli->format == FORMAT_TABLE) {
+        write_grid_table(cli, &grid);
+    } else {
+        for (int d = 0; d < grid.days; d++) {
+            char day[MAX_DATE_LENGTH];
+            day_number_to_date(grid.first_day + d, day);
+            for (int r = 0; r < grid.room_count; r++) {
+                const char* row = grid.cells + ((size_t)d * grid.room_count + r) * grid.cells_per_day;
+                const char* room = bookspace_room(cli->bs, grid.rooms[r])->name;
+                if (cli->format == FORMAT_JSON) {
+                    write_grid_json_row(cli, day, room, row, &grid);
+                } else {
+                    fprintf(cli->out, "%s\t%s\t%.*s\n", day, room, grid.cells_per_day, row);
+                }
+            }
+        }
+    }
+    bookspace_grid_free(&grid);
+    return CLI_OK;
+}
+
+// Profiling dump (--profile) to a local file, or to the output stream with --out -
+static int run_stats(CliSession* cli, const CliOptions* opts) {
+    StatsFormat format = STATS_FORMAT_JSON;
+    if (opts->format && str_equals_ignore_case(opts->format, "prometheus")) {
+        format = STATS_FORMAT_PROMETHEUS;
+    } else if (opts->format && !str_equals_ignore_case(opts->format, "json")) {
+        return report_usage(cli, "stats --format must be json or prometheus");
+    }
+    const char* path = opts->out ? opts->out : opts->positional;
+    if (cli->protocol) {
+        // A socket client must not make the daemon create or truncate files with its privileges
+        if (path && strcmp(path, "-") != 0) {
+            return report_usage(cli, "stats over the socket writes only to the reply (--out -)");
+        }
+        path = "-";
+    } else if (!path) {
+        path = format == STATS_FORMAT_PROMETHEUS ? CLI_STATS_PATH_PROMETHEUS : CLI_STATS_PATH_JSON;
+    }
+
+    if (strcmp(path, "-") == 0) {
+        return bookspace_stats_write(cli->out, format) == BOOKSPACE_OK ? CLI_OK : report_result(cli, BOOKSPACE_ERROR);
+    }
+    FILE* out = fopen(path, "w");
+    if (!out) {
+        return report(cli, CLI_FAILED, "error", "cannot open the stats file for writing");
+    }
+    BookspaceResult result = bookspace_stats_write(out, format);
+    if (fclose(out) != 0 || result != BOOKSPACE_OK) {
+        return report_result(cli, BOOKSPACE_ERROR);
+    }
+
+    cli->replied = 1;
+    if (cli->format == FORMAT_JSON) {
+        fputs("{\"result\":\"ok\",\"action\":\"written\",\"path\":", cli->out);
+        write_json_string(cli->out, path);
+        fputs("}\n", cli->out);
+    } else if (cli->format == FORMAT_TABLE) {
+        fprintf(cli->out, "Statistics written to %s.\n", path);
+    } else {
+        fprintf(cli->out, "ok\t%s\n", path);
+    }
+    return CLI_OK;
+}
+
+static const CliCommand COMMANDS[] = {
+    { "book", run_book, "book --name NAME --student NUM --date MM/DD/YYYY --start TIME --end TIME --room ROOM [--id ID]", 0, 1 },
+    { "cancel", run_cancel, "cancel --id ID", 0, 1 },
+    { "list", run_list, "list [--date MM/DD/YYYY]", 0, 0 },
+    { "search", run_search, "search --name TEXT | --student NUM | --id ID", 0, 0 },
+    { "avail", run_avail, "avail --date MM/DD/YYYY (--start TIME --end TIME [--room ROOM] | --duration MIN [--from TIME] [--room ROOM])", 0, 0 },
+    { "grid", run_grid, "grid --date MM/DD/YYYY [--days N] [--step MIN] [--rooms \"ROOM,ROOM,...\"]", 0, 0 },
+    { "next", run_next, "next --date MM/DD/YYYY --duration MIN [--from TIME] [--room ROOM] [--count K] [--horizon DAYS]", 0, 0 },
+    { "rooms", run_rooms, "rooms", 0, 0 },
+    { "addroom", run_addroom, "addroom --name NAME [--capacity SEATS] [--open TIME] [--close TIME]", 0, 1 },
+    { "import", run_import, "import FILE|- [--batch ROWS]   (rejected rows go to stderr as \"line N: reason\")", 0, 1 },
+    { "stats", run_stats, "stats [--format json|prometheus] [--out FILE|-]   (needs --profile)", 1, 0 }
+};
+#define NUM_COMMANDS (sizeof(COMMANDS) / sizeof(COMMANDS[0]))
+
+static const CliCommand* find_command(const char* name) {
+    for (size_t i = 0; i < NUM_COMMANDS; i++) {
+        if (strcmp(COMMANDS[i].name, name) == 0) {
+            return &COMMANDS[i];
+        }
+    }
+    return NULL;
+}
+
+static int parse_format(const char* name, CliFormat* format) {
+    if (str_equals_ignore_case(name, "tsv")) *format = FORMAT_TSV;
+    else if (str_equals_ignore_case(name, "json")) *format = FORMAT_JSON;
+    else if (str_equals_ignore_case(name, "table")) *format = FORMAT_TABLE;
+    else return 1;
+    return 0;
+}
+
+static void print_usage(FILE* out) {
+    fputs("usage: LibraryReservation [--db PATH] [--format tsv|json|table] [--profile [--slow-ms MS]] <command> [flags]\n"
+          "       LibraryReservation [--db PATH] [--format tsv|json|table] --script <file|->\n"
+          "       LibraryReservation [--db PATH] [--group-max N] [--group-wait-us US] [--readers N]\n"
+          "                          --serve <socket>\n"
+          "       LibraryReservation --connect <socket> (<command> [flags] | --script <file|->)\n"
+          "commands:\n", out);
+    for (size_t i = 0; i < NUM_COMMANDS; i++) {
+        fprintf(out, "  %s\n", COMMANDS[i].usage);
+    }
+}
+
+// Runs one command; argv[0] is the command name
+static int run_command(CliSession* cli, int argc, char* argv[]) {
+    const CliCommand* command = find_command(argv[0]);
+    if (!command) {
+        return report_usage(cli, "unknown command (book, cancel, list, search, avail, next, grid, rooms, addroom, import, stats)");
+    }
+
+    CliOptions opts;
+    memset(&opts, 0, sizeof(opts));
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0) {
+            if (opts.positional) {
+                return report_usage(cli, command->usage);
+            }
+            opts.positional = argv[i];
+            continue;
+        }
+
+        size_t f = 0;
+        while (f < NUM_FLAGS && strcmp(FLAGS[f].flag, argv[i]) != 0) f++;
+        if (f == NUM_FLAGS || i + 1 >= argc) {
+            return report_usage(cli, command->usage);
+        }
+        *(const char**)((char*)&opts + FLAGS[f].offset) = argv[++i];
+    }
+
+    // --format applies to this command only
+    CliFormat saved = cli->format;
+    if (opts.format && !command->own_format && parse_format(opts.format, &cli->format) != 0) {
+        return report_usage(cli, "--format must be tsv, json or table");
+    }
+    int status = command->run(cli, &opts);
+
+    // Protocol mode: queries end with a bare status line so every request gets exactly one
+    if (cli->protocol && !cli->replied) {
+        fputs(cli->format == FORMAT_JSON ? "{\"result\":\"ok\"}\n" : "ok\n", cli->out);
+    }
+    cli->format = saved;
+    return status;
+}
+
+// Splits a script line in place into words; "double" or 'single' quotes group words.
+// Returns the word count, or -1 on an unterminated quote.
+static int split_words(char* line, char* words[], int max_words) {
+    int count = 0;
+    char* read = line;
+    while (count < max_words) {
+        while (isspace((unsigned char)*read)) read++;
+        if (*read == '\0' || *read == '#') break;
+
+        char* write = read;
+        words[count++] = write;
+        while (*read && !isspace((unsigned char)*read)) {
+            if (*read == '"' || *read == '\'') {
+                char quote = *read++;
+                while (*read && *read != quote) *write++ = *read++;
+                if (*read != quote) return -1;
+                read++;
+            } else {
+                *write++ = *read++;
+            }
+        }
+        if (*read) read++;
+        *write = '\0';
+    }
+    return count;
+}
+
+int cli_command_writes(const char* line) {
+    // The command word may be quoted (--connect quotes every word), so split a copy
+    char copy[CLI_MAX_LINE];
+    char* words[1];
+    snprintf(copy, sizeof(copy), "%s", line);
+    if (split_words(copy, words, 1) != 1) {
+        return 0;
+    }
+    const CliCommand* command = find_command(words[0]);
+    return command && command->writes;
+}
+
+void cli_session_init(CliSession* session, Bookspace* bs, FILE* out, FILE* err) {
+    session->bs = bs;
+    session->out = out;
+    session->err = err;
+    session->format = FORMAT_TSV;
+    session->line_no = 0;
+    session->protocol = 0;
+    session->replied = 0;
+}
+
+int cli_execute(CliSession* session, char* line) {
+    char* words[CLI_MAX_ARGS];
+    int count = split_words(line, words, CLI_MAX_ARGS);
+    if (count == 0) {
+        return CLI_OK;
+    }
+
+    session->replied = 0;
+    return count < 0 ? report_usage(session, "unterminated quote") : run_command(session, count, words);
+}
+
+// One command per line, same syntax as the command line without the program name.
+// Blank lines and lines starting with '#' are skipped; a failed command does not stop the script.
+static int run_script(CliSession* cli, FILE* in) {
+    char line[CLI_MAX_LINE];
+    int status = CLI_OK;
+
+    cli->line_no = 0;
+    while (fgets(line, sizeof(line), in)) {
+        cli->line_no++;
+        size_t len = strcspn(line, "\r\n");
+        if (line[len] == '\0' && !feof(in)) {
+            // Longer than the buffer: drop the rest so it never runs as a command of its own
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF);
+            int rc = report_usage(cli, "line too long");
+            if (rc > status) status = rc;
+            continue;
+        }
+        line[len] = '\0';
+
+        int rc = cli_execute(cli, line);
+        if (rc > status) status = rc;
+    }
+    cli->line_no = 0;
+    return status;
+}
+
+// Rebuilds one request line from argv for --connect, quoting every word
+static int join_words(int argc, char* argv[], char* line, size_t size) {
+    size_t len = 0;
+    for (int i = 0; i < argc; i++) {
+        char quote = strchr(argv[i], '"') ? '\'' : '"';
+        int n = snprintf(line + len, size - len, "%s%c%s%c", i ? " " : "", quote, argv[i], quote);
+        if (n < 0 || (size_t)n >= size - len) {
+            return 1;
+        }
+        len += (size_t)n;
+    }
+    return 0;
+}
+
+int cli_main(int argc, char* argv[]) {
+    CliSession cli;
+    cli_session_init(&cli, NULL, stdout, stderr);
+    DatabaseConfig config;
+    database_config_defaults(&config);
+    const char* script = NULL;
+    const char* serve = NULL;
+    const char* connect = NULL;
+    long group_max = SERVER_GROUP_COMMIT_MAX;
+    long group_wait_us = SERVER_GROUP_COMMIT_WAIT_US;
+    long readers = -1;
+    long slow_ms = -1;
+
+    // Global flags come before the command
+    int i = 1;
+    while (i < argc && strncmp(argv[i], "--", 2) == 0) {
+        if (strcmp(argv[i], "--help") == 0) {
+            print_usage(stdout);
+            return CLI_OK;
+        }
+        if (strcmp(argv[i], "--import") == 0) {
+            argv[i] = "import"; // older spelling of the import command
+            break;
+        }
+        if (strcmp(argv[i], "--profile") == 0) {
+            config.profile = 1;
+            i++;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            print_usage(stderr);
+            return CLI_USAGE;
+        }
+        if (strcmp(argv[i], "--db") == 0) {
+            config.path = argv[i + 1];
+        } else if (strcmp(argv[i], "--format") == 0) {
+            if (parse_format(argv[i + 1], &cli.format) != 0) {
+                print_usage(stderr);
+                return CLI_USAGE;
+            }
+        } else if (strcmp(argv[i], "--script") == 0) {
+            script = argv[i + 1];
+        } else if (strcmp(argv[i], "--serve") == 0) {
+            serve = argv[i + 1];
+        } else if (strcmp(argv[i], "--connect") == 0) {
+            connect = argv[i + 1];
+        } else if (strcmp(argv[i], "--group-max") == 0) {
+            if (parse_bounded(argv[i + 1], 1, CLI_MAX_GROUP, &group_max) != 0) {
+                return report_usage(&cli, "--group-max must be a number of writes from 1 to " CLI_STR(CLI_MAX_GROUP));
+            }
+        } else if (strcmp(argv[i], "--group-wait-us") == 0) {
+            if (parse_bounded(argv[i + 1], 0, CLI_MAX_GROUP_WAIT_US, &group_wait_us) != 0) {
+                return report_usage(&cli, "--group-wait-us must be from 0 to " CLI_STR(CLI_MAX_GROUP_WAIT_US) " microseconds");
+            }
+        } else if (strcmp(argv[i], "--readers") == 0) {
+            if (parse_bounded(argv[i + 1], 0, CLI_MAX_READERS, &readers) != 0) {
+                return report_usage(&cli, "--readers must be a thread count from 0 to " CLI_STR(CLI_MAX_READERS));
+            }
+        } else if (strcmp(argv[i], "--slow-ms") == 0) {
+            if (parse_bounded(argv[i + 1], 0, CLI_MAX_SLOW_MS, &slow_ms) != 0) {
+                return report_usage(&cli, "--slow-ms must be from 0 to " CLI_STR(CLI_MAX_SLOW_MS) " milliseconds");
+            }
+            config.slow_query_us = slow_ms * 1000;
+        } else {
+            print_usage(stderr);
+            return CLI_USAGE;
+        }
+        i += 2;
+    }
+    if (serve) {
+        if (i < argc || script || connect) {
+            print_usage(stderr);
+            return CLI_USAGE;
+        }
+        ServerConfig server;
+        server_config_defaults(&server);
+        server.socket_path = serve;
+        server.group_commit_max = (int)group_max;
+        server.group_commit_wait_us = group_wait_us;
+        server.reader_threads = (int)readers;
+        server.database = config;
+        return server_run(&server);
+    }
+    if ((script == NULL) == (i >= argc) || (!script && !find_command(argv[i]))) {
+        print_usage(stderr);
+        return CLI_USAGE;
+    }
+
+    FILE* in = NULL;
+    if (script) {
+        in = strcmp(script, "-") == 0 ? stdin : fopen(script, "r");
+        if (!in) {
+            fprintf(stderr, "Error: cannot open script %s\n", script);
+            return CLI_USAGE;
+        }
+    }
+
+    int status;
+    if (connect) {
+        char request[CLI_MAX_LINE];
+        if (!script && join_words(argc - i, argv + i, request, sizeof(request)) != 0) {
+            fprintf(stderr, "Error: request too long\n");
+            status = CLI_USAGE;
+        } else {
+            status = client_run(connect, in, script ? NULL : request, stdout);
+        }
+    } else if (bookspace_open(&config, &cli.bs) != BOOKSPACE_OK) {
+        fprintf(stderr, "Error: Failed to initialize database.\n");
+        status = CLI_FAILED;
+    } else {
+        status = script ? run_script(&cli, in) : run_command(&cli, argc - i, argv + i);
+        bookspace_close(cli.bs);
+    }
+
+    if (in && in != stdin) {
+        fclose(in);
+    }
+    return status;
+}
@@ -0,0 +1,29 @@
+#include "headers/cli.h"
+#include "headers/server.h"
+#include <stdio.h>
+#include <string.h>
+
+// bookspace-daemon: the --serve mode of LibraryReservation without the menu, for service
+// managers. Takes the same global flags (--db, --profile, --readers, --group-max, ...);
+// the socket defaults to SERVER_DEFAULT_SOCKET when --serve is not given.
+int main(int argc, char* argv[]) {
+    char* args[CLI_MAX_ARGS + 3];
+    if (argc > CLI_MAX_ARGS) {
+        fprintf(stderr, "Error: too many arguments\n");
+        return CLI_USAGE;
+    }
+    int serve = 0;
+    for (int i = 0; i < argc; i++) {
+        args[i] = argv[i];
+        if (strcmp(argv[i], "--serve") == 0) {
+            serve = 1;
+        }
+    }
+    int count = argc;
+    if (!serve) {
+        args[count++] = "--serve";
+        args[count++] = SERVER_DEFAULT_SOCKET;
+    }
+    args[count] = NULL;
+    return cli_main(count, args);
+}
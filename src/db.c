@@ -1,333 +1,1636 @@
 #include "headers/database.h"
 #include "headers/reservation.h"
+#include "headers/interval_index.h"
+#include "headers/availability.h"
+#include "headers/stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-//database connection
-extern sqlite3* db;
-
 //Const
 #define MAX_NAME_LENGTH 100
 #define MAX_DATE_LENGTH 11
 #define MAX_TIME_LENGTH 10
 #define DATABASE_PATH "data/library_reservations.db"
 
-int close_database() {
-    if (db) {
-        sqlite3_close(db);
-        db = NULL;
+// Schema version stored in PRAGMA user_version
+//  0: dates as 'MM/DD/YYYY' TEXT, times as 'HH:MM' TEXT
+//  1: day number (days since 01/01/1970) and minutes since midnight as INTEGER
+//  2: rooms table; reservations reference it by integer room_id instead of the room's name
+#define SCHEMA_VERSION 2
+#define STRINGIFY_VALUE(x) #x
+#define STRINGIFY(x) STRINGIFY_VALUE(x)
+
+// Column order: id(0), student_name(1), student_num(2), day(3), start_min(4), end_min(5), reservation_id(6), room_id(7), created_at(8)
+#define RESERVATION_COLUMNS "id, student_name, student_num, day, start_min, end_min, reservation_id, room_id, created_at"
+
+// Busy-retry policy: every statement waits up to busy_timeout_ms (DatabaseConfig) for a lock
+// held by another terminal. BEGIN/COMMIT then retry up to WRITE_RETRY_LIMIT times, sleeping
+// WRITE_RETRY_DELAY_MS and doubling, so a write gives up after a bounded time.
+#define WRITE_RETRY_LIMIT 8
+#define WRITE_RETRY_DELAY_MS 5
+
+#define RESERVATIONS_TABLE_SQL(name) \
+    "CREATE TABLE IF NOT EXISTS " name " (" \
+    "id INTEGER PRIMARY KEY AUTOINCREMENT," \
+    "student_name TEXT NOT NULL," \
+    "student_num TEXT NOT NULL," \
+    "day INTEGER NOT NULL," \
+    "start_min INTEGER NOT NULL," \
+    "end_min INTEGER NOT NULL," \
+    "reservation_id TEXT NOT NULL UNIQUE," \
+    "room_id INTEGER NOT NULL REFERENCES rooms(id)," \
+    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP," \
+    "UNIQUE(day, start_min, end_min, room_id)" \
+    ");"
+
+// Version 1 layout, the target of the version 0 migration
+#define RESERVATIONS_V1_TABLE_SQL(name) \
+    "CREATE TABLE IF NOT EXISTS " name " (" \
+    "id INTEGER PRIMARY KEY AUTOINCREMENT," \
+    "student_name TEXT NOT NULL," \
+    "student_num TEXT NOT NULL," \
+    "day INTEGER NOT NULL," \
+    "start_min INTEGER NOT NULL," \
+    "end_min INTEGER NOT NULL," \
+    "reservation_id TEXT NOT NULL UNIQUE," \
+    "consultation_room TEXT NOT NULL," \
+    "created_at DATETIME DEFAULT CURRENT_TIMESTAMP," \
+    "UNIQUE(day, start_min, end_min, consultation_room)" \
+    ");"
+
+// Room catalog. Open hours default to library hours and must stay within them, since the
+// availability bitmaps only cover library hours.
+#define ROOMS_TABLE_SQL \
+    "CREATE TABLE IF NOT EXISTS rooms (" \
+    "id INTEGER PRIMARY KEY," \
+    "name TEXT NOT NULL UNIQUE," \
+    "capacity INTEGER NOT NULL DEFAULT 1 CHECK (capacity > 0)," \
+    "open_min INTEGER NOT NULL DEFAULT " STRINGIFY(LIBRARY_OPEN_MINUTES) "," \
+    "close_min INTEGER NOT NULL DEFAULT " STRINGIFY(LIBRARY_CLOSE_MINUTES) "," \
+    "CHECK (open_min >= " STRINGIFY(LIBRARY_OPEN_MINUTES) " AND close_min <= " STRINGIFY(LIBRARY_CLOSE_MINUTES) \
+    " AND open_min < close_min)" \
+    ");"
+
+// The four consultation rooms every database started with, seeded into an empty catalog
+#define DEFAULT_ROOMS_SQL \
+    "INSERT INTO rooms (id, name, capacity) SELECT column1, column2, column3 FROM (VALUES " \
+    "(1, 'Room A', 4), (2, 'Room B', 4), (3, 'Room C', 4), (4, 'Room D', 4)) " \
+    "WHERE NOT EXISTS (SELECT 1 FROM rooms);"
+
+// Name search ranking (case-insensitive, as LIKE is for ASCII): names starting with the
+// term first, then names with a word starting with it, then other substring matches
+#define NAME_MATCH_RANK \
+    "CASE WHEN student_name LIKE ?1 || '%' THEN 0 WHEN student_name LIKE '% ' || ?1 || '%' THEN 1 ELSE 2 END"
+
+// Trigram index over student_name for substring search. External content: the index
+// stores only trigrams and reads names back from reservations, and the triggers keep
+// it in step with every insert, delete and name change.
+#define NAME_INDEX_SQL \
+    "CREATE VIRTUAL TABLE IF NOT EXISTS reservation_names USING fts5(" \
+    "student_name, content='reservations', content_rowid='id', tokenize='trigram case_sensitive 0');" \
+    "CREATE TRIGGER IF NOT EXISTS reservation_names_insert AFTER INSERT ON reservations BEGIN " \
+    "INSERT INTO reservation_names(rowid, student_name) VALUES (new.id, new.student_name); END;" \
+    "CREATE TRIGGER IF NOT EXISTS reservation_names_delete AFTER DELETE ON reservations BEGIN " \
+    "INSERT INTO reservation_names(reservation_names, rowid, student_name) VALUES ('delete', old.id, old.student_name); END;" \
+    "CREATE TRIGGER IF NOT EXISTS reservation_names_update AFTER UPDATE OF student_name ON reservations BEGIN " \
+    "INSERT INTO reservation_names(reservation_names, rowid, student_name) VALUES ('delete', old.id, old.student_name);" \
+    "INSERT INTO reservation_names(rowid, student_name) VALUES (new.id, new.student_name); END;"
+
+// Shortest term the trigram index can answer
+#define NAME_INDEX_MIN_CHARS 3
+
+// Prepared statement registry
+// Every query is prepared once in initialize_database(), reused through
+// sqlite3_reset()/sqlite3_bind_*() and finalized in close_database().
+typedef enum {
+    STMT_CHECK_CONFLICT,
+    STMT_INSERT_RESERVATION,
+    STMT_DELETE_RESERVATION,
+    STMT_RESERVATION_EXISTS,
+    STMT_UPDATE_RESERVATION,
+    STMT_RESERVATIONS_BY_DATE,
+    STMT_RESERVATIONS_BY_STUDENT_NUM,
+    STMT_RESERVATIONS_BY_ID,
+    STMT_ALL_RESERVATIONS,
+    STMT_RESERVATIONS_BY_NAME,
+    STMT_RESERVATIONS_BY_NAME_INDEX,
+    STMT_DAY_INTERVALS,
+    STMT_RESERVATION_SLOT,
+    STMT_DAY_BOOKINGS,
+    STMT_ROOM_BOOKINGS,
+    STMT_ROOMS,
+    STMT_INSERT_ROOM,
+    STMT_BEGIN_IMMEDIATE,
+    STMT_COMMIT,
+    STMT_ROLLBACK,
+    STMT_DATA_VERSION,
+    STMT_COUNT
+} StatementId;
+
+// Statement labels for the profiling output (stats.h)
+static const char* STATEMENT_NAMES[STMT_COUNT + 1] = {
+    [STMT_CHECK_CONFLICT] = "check_conflict",
+    [STMT_INSERT_RESERVATION] = "insert_reservation",
+    [STMT_DELETE_RESERVATION] = "delete_reservation",
+    [STMT_RESERVATION_EXISTS] = "reservation_exists",
+    [STMT_UPDATE_RESERVATION] = "update_reservation",
+    [STMT_RESERVATIONS_BY_DATE] = "reservations_by_date",
+    [STMT_RESERVATIONS_BY_STUDENT_NUM] = "reservations_by_student_num",
+    [STMT_RESERVATIONS_BY_ID] = "reservations_by_id",
+    [STMT_ALL_RESERVATIONS] = "all_reservations",
+    [STMT_RESERVATIONS_BY_NAME] = "reservations_by_name_scan",
+    [STMT_RESERVATIONS_BY_NAME_INDEX] = "reservations_by_name_index",
+    [STMT_DAY_INTERVALS] = "day_intervals",
+    [STMT_RESERVATION_SLOT] = "reservation_slot",
+    [STMT_DAY_BOOKINGS] = "day_bookings",
+    [STMT_ROOM_BOOKINGS] = "room_bookings",
+    [STMT_ROOMS] = "rooms",
+    [STMT_INSERT_ROOM] = "insert_room",
+    [STMT_BEGIN_IMMEDIATE] = "begin_immediate",
+    [STMT_COMMIT] = "commit",
+    [STMT_ROLLBACK] = "rollback",
+    [STMT_DATA_VERSION] = "data_version",
+    [STMT_COUNT] = "other"  // pragmas, migrations and other one-off SQL
+};
+
+// check_plan = 1 marks hot queries that must be served by an index (see check_query_plans).
+// optional = 1 marks statements on features the linked SQLite may lack (FTS5); they are
+// left NULL when they do not prepare and their callers fall back to a plainer query.
+typedef struct {
+    const char* sql;
+    int check_plan;
+    int optional;
+} StatementDef;
+
+static const StatementDef STATEMENT_DEFS[STMT_COUNT] = {
+    // STMT_CHECK_CONFLICT: ?1 day, ?2 room, ?3 start_min, ?4 end_min, ?5 reservation to ignore (NULL = none)
+    { "SELECT COUNT(*) FROM reservations "
+      "WHERE day = ?1 AND room_id = ?2 "
+      "AND start_min < ?4 AND end_min > ?3 "
+      "AND (?5 IS NULL OR reservation_id <> ?5);", 1, 0 },
+
+    // STMT_INSERT_RESERVATION
+    { "INSERT INTO reservations (student_name, student_num, day, start_min, end_min, reservation_id, room_id) "
+      "VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7);", 0, 0 },
+
+    // STMT_DELETE_RESERVATION: returns the freed slot so the interval cache can drop it
+    { "DELETE FROM reservations WHERE reservation_id = ?1 "
+      "RETURNING room_id, day, start_min, end_min;", 1, 0 },
+
+    // STMT_RESERVATION_EXISTS
+    { "SELECT COUNT(*) FROM reservations WHERE reservation_id = ?1;", 1, 0 },
+
+    // STMT_UPDATE_RESERVATION
+    { "UPDATE reservations SET "
+      "student_name = ?1, student_num = ?2, day = ?3, start_min = ?4, end_min = ?5, room_id = ?6 "
+      "WHERE reservation_id = ?7;", 1, 0 },
+
+    // STMT_RESERVATIONS_BY_DATE
+    { "SELECT " RESERVATION_COLUMNS " FROM reservations WHERE day = ?1 ORDER BY start_min;", 1, 0 },
+
+    // STMT_RESERVATIONS_BY_STUDENT_NUM
+    { "SELECT " RESERVATION_COLUMNS " FROM reservations WHERE student_num = ?1 ORDER BY day, start_min;", 1, 0 },
+
+    // STMT_RESERVATIONS_BY_ID
+    { "SELECT " RESERVATION_COLUMNS " FROM reservations WHERE reservation_id = ?1;", 1, 0 },
+
+    // STMT_ALL_RESERVATIONS: reads every row by design
+    { "SELECT " RESERVATION_COLUMNS " FROM reservations ORDER BY day, start_min;", 0, 0 },
+
+    // STMT_RESERVATIONS_BY_NAME: a leading '%' wildcard cannot use a b-tree index, so this
+    // full scan only serves terms too short for the trigram index (and builds without FTS5)
+    { "SELECT " RESERVATION_COLUMNS " FROM reservations WHERE student_name LIKE '%' || ?1 || '%' "
+      "ORDER BY " NAME_MATCH_RANK ", day, start_min;", 0, 0 },
+
+    // STMT_RESERVATIONS_BY_NAME_INDEX: ?1 term of 3+ characters; trigram lookup in
+    // reservation_names, then rowid seeks. FTS5 plans always read "SCAN ... VIRTUAL TABLE".
+    { "SELECT " RESERVATION_COLUMNS " FROM reservations WHERE id IN "
+      "(SELECT rowid FROM reservation_names WHERE reservation_names MATCH '\"' || replace(?1, '\"', '\"\"') || '\"') "
+      "ORDER BY " NAME_MATCH_RANK ", day, start_min;", 0, 1 },
+
+    // STMT_DAY_INTERVALS: ?1 room_id, ?2 day; loads one cold key of the interval cache
+    { "SELECT start_min, end_min FROM reservations "
+      "WHERE room_id = ?1 AND day = ?2 ORDER BY start_min;", 1, 0 },
+
+    // STMT_RESERVATION_SLOT: current slot of a reservation before it is edited
+    { "SELECT room_id, day, start_min, end_min FROM reservations WHERE reservation_id = ?1;", 1, 0 },
+
+    // STMT_DAY_BOOKINGS: ?1 day; every room's bookings for one availability bitmap
+    { "SELECT room_id, start_min, end_min FROM reservations WHERE day = ?1;", 1, 0 },
+
+    // STMT_ROOM_BOOKINGS: ?1 room_id, ?2 first day, ?3 last day; one room's bookings in
+    // time order, streamed by the free slot search
+    { "SELECT day, start_min, end_min FROM reservations "
+      "WHERE room_id = ?1 AND day BETWEEN ?2 AND ?3 ORDER BY day, start_min;", 1, 0 },
+
+    // STMT_ROOMS: the whole catalog, in id order (reads every row by design)
+    { "SELECT id, name, capacity, open_min, close_min FROM rooms ORDER BY id;", 0, 0 },
+
+    // STMT_INSERT_ROOM
+    { "INSERT INTO rooms (name, capacity, open_min, close_min) VALUES (?1, ?2, ?3, ?4);", 0, 0 },
+
+    // Transaction control for write_begin(bs)/write_end(bs)
+    { "BEGIN IMMEDIATE;", 0, 0 },
+    { "COMMIT;", 0, 0 },
+    { "ROLLBACK;", 0, 0 },
+
+    // STMT_DATA_VERSION: changes whenever another connection commits
+    { "PRAGMA data_version;", 0, 0 }
+};
+
+// In-memory copy of the rooms table, sorted by id; a room's index is its position
+typedef struct {
+    Room* rooms;
+    int count;
+    int capacity;
+} RoomCatalog;
+
+// One open database: connection, prepared statements, caches and pragma profile.
+// Everything that used to be file-level state lives here, so each thread or service
+// worker can own its own context.
+struct Bookspace {
+    sqlite3* db;
+    sqlite3_stmt* statements[STMT_COUNT];
+
+    // Room catalog, loaded at open and whenever the database may have gained rooms.
+    // The interval cache and the availability bitmaps are keyed by catalog index.
+    RoomCatalog catalog;
+
+    // Booked intervals per (room, day), filled lazily from STMT_DAY_INTERVALS and kept in step
+    // with every write made through this connection. The database stays the authority: a cold
+    // key is always loaded from it before being trusted.
+    IntervalIndex interval_cache;
+
+    // Slot bitmaps per day for availability queries, loaded with one query per day.
+    // Inserts set bits in place; removals drop the day so it is rebuilt from the database.
+    AvailabilityCache availability_cache;
+
+    // PRAGMA data_version seen when the caches were last known to match the database
+    sqlite3_int64 cached_data_version;
+
+    // Pragma profile applied at open; see database_config_defaults()
+    DatabaseConfig config;
+    int wal_enabled;
+    int commits_since_checkpoint;
+
+    // Profiling: start time of the running statement per registry slot (STMT_COUNT = other)
+    long long statement_started_ns[STMT_COUNT + 1];
+};
+
+// sqlite3_trace_v2 hook. SQLITE_TRACE_PROFILE alone only has millisecond resolution,
+// so the start is taken at SQLITE_TRACE_STMT and the end at SQLITE_TRACE_PROFILE.
+static int trace_statement(unsigned type, void* context, void* p, void* x) {
+    Bookspace* bs = context;
+    sqlite3_stmt* stmt = p;
+    int slot = 0;
+    while (slot < STMT_COUNT && bs->statements[slot] != stmt) slot++;
+
+    if (type == SQLITE_TRACE_STMT) {
+        // Trigger bodies report again with "-- TRIGGER name"; keep the statement's own start
+        const char* text = x;
+        if (!(text && text[0] == '-' && text[1] == '-')) {
+            bs->statement_started_ns[slot] = stats_now_ns();
+        }
+    } else if (type == SQLITE_TRACE_PROFILE && bs->statement_started_ns[slot] != 0) {
+        stats_record_statement(slot, STATEMENT_NAMES[slot], sqlite3_sql(stmt),
+                               stats_now_ns() - bs->statement_started_ns[slot]);
+        bs->statement_started_ns[slot] = 0;
+    }
+    return 0;
+}
+
+static int prepare_statements(Bookspace* bs) {
+    for (int i = 0; i < STMT_COUNT; i++) {
+        int rc = sqlite3_prepare_v3(bs->db, STATEMENT_DEFS[i].sql, -1, SQLITE_PREPARE_PERSISTENT, &bs->statements[i], NULL);
+        if (rc != SQLITE_OK && STATEMENT_DEFS[i].optional) {
+            bs->statements[i] = NULL;
+            continue;
+        }
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "SQL error while preparing statement %d: %s\n", i, sqlite3_errmsg(bs->db));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void finalize_statements(Bookspace* bs) {
+    for (int i = 0; i < STMT_COUNT; i++) {
+        sqlite3_finalize(bs->statements[i]); // harmless on NULL
+        bs->statements[i] = NULL;
+    }
+}
+
+// Runs EXPLAIN QUERY PLAN on every hot query and warns when one falls back to a full scan.
+// Returns the number of queries that did.
+static int check_query_plans(Bookspace* bs) {
+    int warnings = 0;
+
+    for (int i = 0; i < STMT_COUNT; i++) {
+        if (!STATEMENT_DEFS[i].check_plan) continue;
+
+        char* sql = sqlite3_mprintf("EXPLAIN QUERY PLAN %s", STATEMENT_DEFS[i].sql);
+        sqlite3_stmt* plan = NULL;
+        int rc = sqlite3_prepare_v2(bs->db, sql, -1, &plan, NULL);
+        sqlite3_free(sql);
+        if (rc != SQLITE_OK) {
+            fprintf(stderr, "Warning: could not explain statement %d: %s\n", i, sqlite3_errmsg(bs->db));
+            warnings++;
+            continue;
+        }
+
+        // Plan rows: id, parent, notused, detail. SEARCH means an index seek; SCAN visits
+        // every row of the table (or of a whole index, which is no better).
+        while (sqlite3_step(plan) == SQLITE_ROW) {
+            const char* detail = (const char*)sqlite3_column_text(plan, 3);
+            if (detail && strncmp(detail, "SCAN ", 5) == 0) {
+                fprintf(stderr, "Warning: query falls back to a full scan (%s):\n  %s\n", detail, STATEMENT_DEFS[i].sql);
+                warnings++;
+                break;
+            }
+        }
+        sqlite3_finalize(plan);
+    }
+    return warnings;
+}
+
+// Returns the cached statement for id, ready for new bindings
+static sqlite3_stmt* get_statement(Bookspace* bs, StatementId id) {
+    sqlite3_stmt* stmt = bs->statements[id];
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return stmt;
+}
+
+// Binds a text parameter; the caller's string must outlive the step
+static void bind_text(sqlite3_stmt* stmt, int index, const char* value) {
+    sqlite3_bind_text(stmt, index, value, -1, SQLITE_STATIC);
+}
+
+// Runs a statement that returns no rows
+static int step_done(sqlite3_stmt* stmt) {
+    int rc = sqlite3_step(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(sqlite3_db_handle(stmt)));
+        sqlite3_reset(stmt);
+        return 1;
+    }
+    sqlite3_reset(stmt);
+    return 0;
+}
+
+// Runs a SELECT COUNT(*) statement, -1 on error
+static int step_count(sqlite3_stmt* stmt) {
+    int count = -1;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        count = sqlite3_column_int(stmt, 0);
+    } else {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(sqlite3_db_handle(stmt)));
+    }
+    sqlite3_reset(stmt);
+    return count;
+}
+
+// Opens a cursor on a prepared reservation SELECT (bindings already applied);
+// op is the profiled operation it belongs to, timed until the cursor ends or closes
+static int open_cursor(Bookspace* bs, ReservationCursor* cursor, sqlite3_stmt* stmt, StatsOp op) {
+    cursor->bs = bs;
+    cursor->stmt = stmt;
+    cursor->done = 0;
+    cursor->started_ns = stats_start();
+    cursor->op = cursor->started_ns ? (int)op : -1;
+    return 0;
+}
+
+static void finish_cursor_op(ReservationCursor* cursor) {
+    if (cursor->op >= 0) {
+        stats_finish((StatsOp)cursor->op, cursor->started_ns);
+        cursor->op = -1;
+    }
+}
+
+void database_config_defaults(DatabaseConfig* config) {
+    config->path = DATABASE_PATH;
+    config->journal_mode = "WAL";         // readers never block on a writer
+    config->synchronous = "NORMAL";       // safe with WAL; fsync only at checkpoints
+    config->busy_timeout_ms = 250;
+    config->cache_size_kib = 8192;        // page cache per connection
+    config->mmap_size = 64LL * 1024 * 1024;
+    config->temp_store_memory = 1;
+    config->wal_autocheckpoint_pages = 1000;
+    config->checkpoint_every_commits = 100;
+    config->wal_truncate_pages = 4096;    // ~16 MB at the default page size
+    config->journal_size_limit = 16LL * 1024 * 1024;
+    config->read_only = 0;
+    config->profile = 0;
+    config->slow_query_us = 50000;
+    config->serialized = 0;
+}
+
+// Process-wide SQLite settings, applied before the first connection initializes the
+// library. A tuned amalgamation (CMakeLists.txt) has them compiled in already. Once SQLite
+// is initialized, sqlite3_config() refuses with SQLITE_MISUSE and the host's choice stands.
+static void configure_engine(void) {
+    static int configured = 0;
+    if (!configured) {
+        configured = 1;
+        sqlite3_config(SQLITE_CONFIG_MEMSTATUS, 0); // no global allocation counters (and their mutex)
     }
+}
+
+// Applies the pragma profile. journal_mode is read back because SQLite silently keeps the
+// old mode when WAL is not possible (e.g. on a network share).
+static int apply_pragmas(Bookspace* bs) {
+    const DatabaseConfig* config = &bs->config;
+    sqlite3_busy_timeout(bs->db, config->busy_timeout_ms);
+
+    char* sql = sqlite3_mprintf(
+        "PRAGMA synchronous = %s;"
+        "PRAGMA cache_size = %d;"
+        "PRAGMA mmap_size = %lld;"
+        "PRAGMA temp_store = %s;"
+        "PRAGMA journal_size_limit = %lld;"
+        "PRAGMA foreign_keys = ON;",
+        config->synchronous, -config->cache_size_kib, config->mmap_size,
+        config->temp_store_memory ? "MEMORY" : "DEFAULT", config->journal_size_limit);
+    char* err_msg = 0;
+    int rc = sqlite3_exec(bs->db, sql, 0, 0, &err_msg);
+    sqlite3_free(sql);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error while applying pragmas: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        return 1;
+    }
+
+    // A read-only connection cannot change the journal mode, only report it
+    sql = config->read_only ? sqlite3_mprintf("PRAGMA journal_mode;")
+                            : sqlite3_mprintf("PRAGMA journal_mode = %s;", config->journal_mode);
+    sqlite3_stmt* stmt = NULL;
+    rc = sqlite3_prepare_v2(bs->db, sql, -1, &stmt, NULL);
+    sqlite3_free(sql);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        return 1;
+    }
+    const char* mode = sqlite3_step(stmt) == SQLITE_ROW ? (const char*)sqlite3_column_text(stmt, 0) : NULL;
+    bs->wal_enabled = mode && sqlite3_stricmp(mode, "wal") == 0;
+    if (!config->read_only && (!mode || sqlite3_stricmp(mode, config->journal_mode) != 0)) {
+        fprintf(stderr, "Warning: journal_mode %s requested, database is using %s.\n",
+                config->journal_mode, mode ? mode : "unknown");
+    }
+    sqlite3_finalize(stmt);
+
+    if (bs->wal_enabled && !config->read_only) {
+        sqlite3_wal_autocheckpoint(bs->db, config->wal_autocheckpoint_pages);
+    }
+    return 0;
+}
+
+int checkpoint_database(Bookspace* bs, int truncate) {
+    // Copies WAL frames back into the database. A PASSIVE checkpoint never blocks; TRUNCATE
+    // waits (up to the busy timeout) for readers and then resets the WAL file to zero bytes.
+    if (!bs->db || !bs->wal_enabled || bs->config.read_only) return 0;
+
+    int log_frames = 0, checkpointed = 0;
+    int rc = sqlite3_wal_checkpoint_v2(bs->db, NULL, truncate ? SQLITE_CHECKPOINT_TRUNCATE : SQLITE_CHECKPOINT_PASSIVE,
+                                       &log_frames, &checkpointed);
+    bs->commits_since_checkpoint = 0;
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+        fprintf(stderr, "SQL error during checkpoint: %s\n", sqlite3_errmsg(bs->db));
+        return 1;
+    }
+
+    // Long-lived readers can stop the automatic checkpoints from ever resetting the WAL;
+    // once it is over the limit, force a truncating checkpoint
+    if (!truncate && log_frames > bs->config.wal_truncate_pages) {
+        return checkpoint_database(bs, 1);
+    }
+    return 0;
+}
+
+// Periodic checkpoint policy, called after every successful commit
+static void note_commit(Bookspace* bs) {
+    if (bs->wal_enabled && bs->config.checkpoint_every_commits > 0 &&
+        ++bs->commits_since_checkpoint >= bs->config.checkpoint_every_commits) {
+        checkpoint_database(bs, 0);
+    }
+}
+
+int close_database(Bookspace* bs) {
+    if (!bs) {
+        return 0;
+    }
+    if (bs->db) {
+        // Leave a zero-length WAL behind for the next start
+        checkpoint_database(bs, 1);
+        finalize_statements(bs);
+        sqlite3_close(bs->db);
+        bs->db = NULL;
+    }
+    interval_index_free(&bs->interval_cache);
+    availability_cache_free(&bs->availability_cache);
+    free(bs->catalog.rooms);
+    free(bs);
     return 0; 
 }
 
-int initialize_database() {
-    // Open database connection
+static int sync_caches(Bookspace* bs);
+
+// (Re)reads the rooms table into the catalog. Cached intervals and bitmaps are keyed by
+// catalog index, so they are dropped whenever the catalog is replaced.
+static int load_rooms(Bookspace* bs) {
+    RoomCatalog* catalog = &bs->catalog;
+    catalog->count = 0;
+    interval_index_clear(&bs->interval_cache);
+    availability_cache_free(&bs->availability_cache);
+
+    sqlite3_stmt* stmt = get_statement(bs, STMT_ROOMS);
     int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (catalog->count == catalog->capacity) {
+            int capacity = catalog->capacity ? catalog->capacity * 2 : 16;
+            Room* rooms = realloc(catalog->rooms, (size_t)capacity * sizeof(*rooms));
+            if (!rooms) {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            catalog->rooms = rooms;
+            catalog->capacity = capacity;
+        }
+        Room* room = &catalog->rooms[catalog->count++];
+        room->id = sqlite3_column_int(stmt, 0);
+        snprintf(room->name, sizeof(room->name), "%s", (const char*)sqlite3_column_text(stmt, 1));
+        room->capacity = sqlite3_column_int(stmt, 2);
+        room->open_min = sqlite3_column_int(stmt, 3);
+        room->close_min = sqlite3_column_int(stmt, 4);
+    }
+    sqlite3_reset(stmt);
 
-    rc = sqlite3_open(DATABASE_PATH, &db);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error while loading rooms: %s\n", sqlite3_errmsg(bs->db));
+        catalog->count = 0;
+        return 1;
+    }
+    return 0;
+}
+
+// Catalog index of a rooms.id, -1 if unknown
+static int room_index_of_id(const RoomCatalog* catalog, int id) {
+    int lo = 0, hi = catalog->count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (catalog->rooms[mid].id == id) return mid;
+        if (catalog->rooms[mid].id < id) lo = mid + 1;
+        else hi = mid - 1;
+    }
+    return -1;
+}
+
+// Catalog index of a room id read from a reservation; a miss means another connection
+// added the room after we loaded the catalog, so reload once
+static int room_of_id(Bookspace* bs, int id) {
+    int room = room_index_of_id(&bs->catalog, id);
+    if (room < 0 && load_rooms(bs) == 0) {
+        room = room_index_of_id(&bs->catalog, id);
+    }
+    return room;
+}
+
+// Picks up rooms added by other connections first, so listings over the catalog are current
+int room_count(Bookspace* bs) {
+    sync_caches(bs);
+    return bs->catalog.count;
+}
+
+const Room* room_at(Bookspace* bs, int room) {
+    return room >= 0 && room < bs->catalog.count ? &bs->catalog.rooms[room] : NULL;
+}
+
+int find_room(Bookspace* bs, const char* name) {
+    // A few hundred short names; a linear scan beats keeping a second sorted index in step
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < bs->catalog.count; i++) {
+            if (strcmp(bs->catalog.rooms[i].name, name) == 0) {
+                return i;
+            }
+        }
+        if (pass == 0 && load_rooms(bs) != 0) break; // the room may be newer than our copy
+    }
+    return -1;
+}
+
+// Opens the database described by config (NULL = database_config_defaults) and returns a
+// new context in *out. The config's strings are only read while opening.
+int initialize_database(const DatabaseConfig* config, Bookspace** out) {
+    int rc;
+
+    *out = NULL;
+    Bookspace* bs = calloc(1, sizeof(*bs));
+    if (!bs) {
+        fprintf(stderr, "Out of memory opening database.\n");
+        return 1;
+    }
+    if (config) {
+        bs->config = *config;
+    } else {
+        database_config_defaults(&bs->config);
+    }
+    bs->cached_data_version = -1;
+    interval_index_init(&bs->interval_cache);
+    availability_cache_init(&bs->availability_cache);
+
+    // Open database connection. A context is used by one thread at a time (the menu, the
+    // daemon's event loop, one reader pool worker), so SQLite's per-connection mutex is
+    // not needed: this is the multi-thread mode of SQLITE_THREADSAFE=2.
+    configure_engine();
+    int flags = bs->config.read_only ? SQLITE_OPEN_READONLY : SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
+    flags |= bs->config.serialized ? SQLITE_OPEN_FULLMUTEX : SQLITE_OPEN_NOMUTEX;
+    rc = sqlite3_open_v2(bs->config.path, &bs->db, flags, NULL);
     if (rc) {
-        fprintf(stderr, "Can't open database: %s\n", sqlite3_errmsg(db));
+        fprintf(stderr, "Can't open database: %s\n", sqlite3_errmsg(bs->db));
+        sqlite3_close(bs->db);
+        bs->db = NULL;
+        close_database(bs);
         return 1;
     }
 
-    // Create tables if they don't exist
-    if (create_tables() != 0) {
+    // Opt-in profiling; registered first so schema setup is counted under "other"
+    if (bs->config.profile) {
+        stats_enable(bs->config.slow_query_us);
+        sqlite3_trace_v2(bs->db, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE, trace_statement, bs);
+    }
+
+    // Journal mode, sync level, busy timeout, cache and mmap sizes
+    if (apply_pragmas(bs) != 0) {
+        close_database(bs);
+        return 1;
+    }
+
+    // Create tables if they don't exist; readers rely on the writer having done it
+    if (!bs->config.read_only && create_tables(bs) != 0) {
         fprintf(stderr, "Failed to create tables.\n");
-        sqlite3_close(db);
+        close_database(bs);
+        return 1;
+    }
+
+    // Prepare every query once for the lifetime of the connection
+    if (prepare_statements(bs) != 0) {
+        fprintf(stderr, "Failed to prepare statements.\n");
+        close_database(bs);
+        return 1;
+    }
+
+    if (load_rooms(bs) != 0) {
+        close_database(bs);
         return 1;
     }
+
+    // Startup self-check: hot queries must be index-backed (once, on the read-write context)
+    if (!bs->config.read_only) {
+        check_query_plans(bs);
+    }
+    *out = bs;
     return 0;
 }
 
-int create_tables() {
-    char* sql = "CREATE TABLE IF NOT EXISTS reservations ("
-                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-                "student_name TEXT NOT NULL,"
-                "student_num TEXT NOT NULL,"
-                "date TEXT NOT NULL,"
-                "start_time TEXT NOT NULL,"
-                "end_time TEXT NOT NULL,"
-                "reservation_id TEXT NOT NULL UNIQUE,"
-                "consultation_room TEXT NOT NULL,"
-                "created_at DATETIME DEFAULT CURRENT_TIMESTAMP,"
-                "UNIQUE(date, start_time, end_time, consultation_room)"
-                ");";
+// Rebuilds a version 0 table (TEXT dates and times) into the integer layout.
+// SQLite cannot change column types in place, so the rows are copied into a new
+// table which then replaces the old one, all inside one transaction.
+static int migrate_text_dates_to_integers(Bookspace* bs) {
+    char* sql =
+        "BEGIN;"
+        RESERVATIONS_V1_TABLE_SQL("reservations_v1")
+        "INSERT INTO reservations_v1 (id, student_name, student_num, day, start_min, end_min, reservation_id, consultation_room, created_at) "
+        "SELECT id, student_name, student_num, "
+        "CAST(julianday(substr(date, 7, 4) || '-' || substr(date, 1, 2) || '-' || substr(date, 4, 2)) - julianday('1970-01-01') AS INTEGER), "
+        "CAST(substr(start_time, 1, 2) AS INTEGER) * 60 + CAST(substr(start_time, 4, 2) AS INTEGER), "
+        "CAST(substr(end_time, 1, 2) AS INTEGER) * 60 + CAST(substr(end_time, 4, 2) AS INTEGER), "
+        "reservation_id, consultation_room, created_at "
+        "FROM reservations;"
+        "DROP TABLE reservations;"
+        "ALTER TABLE reservations_v1 RENAME TO reservations;"
+        "PRAGMA user_version = 1;"
+        "COMMIT;";
     char* err_msg = 0;
-    int rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
+    int rc = sqlite3_exec(bs->db, sql, 0, 0, &err_msg);
 
     if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
+        fprintf(stderr, "SQL error while migrating reservations: %s\n", err_msg);
         sqlite3_free(err_msg);
+        sqlite3_exec(bs->db, "ROLLBACK;", 0, 0, 0);
         return 1;
     }
     return 0;
 }
 
-
-int check_time_conflict(const char* date, const char* start_time, const char* end_time, const char* consultation_room) {
-    char sql[600];
+// Version 1 -> 2: moves room names into the rooms table. The four original rooms keep
+// ids 1-4, any other name found in reservations gets the next id, and the reservations
+// are copied into a table that stores room_id instead of the name.
+static int migrate_room_names_to_ids(Bookspace* bs) {
+    char* sql =
+        "BEGIN;"
+        ROOMS_TABLE_SQL
+        DEFAULT_ROOMS_SQL
+        "INSERT OR IGNORE INTO rooms (name) SELECT DISTINCT consultation_room FROM reservations ORDER BY 1;"
+        RESERVATIONS_TABLE_SQL("reservations_v2")
+        "INSERT INTO reservations_v2 (id, student_name, student_num, day, start_min, end_min, reservation_id, room_id, created_at) "
+        "SELECT r.id, r.student_name, r.student_num, r.day, r.start_min, r.end_min, r.reservation_id, rooms.id, r.created_at "
+        "FROM reservations r JOIN rooms ON rooms.name = r.consultation_room;"
+        "DROP TABLE reservations;"
+        "ALTER TABLE reservations_v2 RENAME TO reservations;"
+        "PRAGMA user_version = 2;"
+        "COMMIT;";
     char* err_msg = 0;
-    int conflict = 0;
+    int rc = sqlite3_exec(bs->db, sql, 0, 0, &err_msg);
 
-    // convert to 24-hour format
-    char start_24[MAX_TIME_LENGTH], end_24[MAX_TIME_LENGTH];
-    format_time_24hour((char*)start_time, start_24);
-    format_time_24hour((char*)end_time, end_24);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error while migrating rooms: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(bs->db, "ROLLBACK;", 0, 0, 0);
+        return 1;
+    }
+    return 0;
+}
 
-    // Only check conflicts within the SAME room
-    sprintf(sql,
-        "SELECT COUNT(*) FROM reservations "
-        "WHERE date = '%s' AND consultation_room = '%s' AND ("
-        "   (start_time < '%s' AND end_time > '%s') OR "
-        "   (start_time >= '%s' AND start_time < '%s') OR "
-        "   (end_time > '%s' AND end_time <= '%s')"
-        ");",
-        date, consultation_room, end_24, start_24, start_24, end_24, start_24, end_24);
+// Brings the schema up to SCHEMA_VERSION, one version step at a time
+static int migrate_schema(Bookspace* bs) {
+    sqlite3_stmt* stmt = NULL;
+    int version = 0;
+    int has_text_dates = 0;
 
-    int rc = sqlite3_exec(db, sql, callback_count_reservations, &conflict, &err_msg);
+    if (sqlite3_prepare_v2(bs->db, "PRAGMA user_version;", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        return 1;
+    }
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        version = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (version == 0) {
+        // Version 0 databases were never stamped, so look for the old 'date' column
+        if (sqlite3_prepare_v2(bs->db, "SELECT 1 FROM pragma_table_info('reservations') WHERE name = 'date';", -1, &stmt, NULL) != SQLITE_OK) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+            return 1;
+        }
+        has_text_dates = sqlite3_step(stmt) == SQLITE_ROW;
+        sqlite3_finalize(stmt);
+
+        if (has_text_dates) {
+            if (migrate_text_dates_to_integers(bs) != 0) {
+                return 1;
+            }
+            version = 1;
+        }
+    }
+    if (version == 1 && migrate_room_names_to_ids(bs) != 0) {
+        return 1;
+    }
+    return 0;
+}
 
+// Creates the trigram name index, filling it from the existing rows the first time.
+// Without FTS5 in the linked SQLite, name search keeps using the LIKE scan.
+static int create_name_index(Bookspace* bs) {
+    sqlite3_stmt* stmt = NULL;
+    if (sqlite3_prepare_v2(bs->db, "SELECT 1 FROM sqlite_master WHERE name = 'reservation_names';", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        return 1;
+    }
+    int exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+
+    char* err_msg = 0;
+    char* sql = exists ? NAME_INDEX_SQL
+                       : "BEGIN;" NAME_INDEX_SQL "INSERT INTO reservation_names(reservation_names) VALUES ('rebuild');COMMIT;";
+    int rc = sqlite3_exec(bs->db, sql, 0, 0, &err_msg);
     if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
+        fprintf(stderr, "Warning: name search index unavailable (%s); searches scan the table.\n", err_msg);
         sqlite3_free(err_msg);
-        return 1; // error
+        if (!sqlite3_get_autocommit(bs->db)) {
+            sqlite3_exec(bs->db, "ROLLBACK;", 0, 0, 0);
+        }
     }
-
-    return conflict > 0 ? 1 : 0; // 1 = conflict, 0 = available
+    return 0;
 }
 
+int create_tables(Bookspace* bs) {
+    if (migrate_schema(bs) != 0) {
+        return 1;
+    }
 
-int insert_reservation(const char* name, const char* student_num, const char* date, const char* start_time, const char* end_time, const char* reservation_id, const char* consultation_room) {
+    char* sql = "BEGIN;" ROOMS_TABLE_SQL DEFAULT_ROOMS_SQL
+                RESERVATIONS_TABLE_SQL("reservations")
+                "PRAGMA user_version = " STRINGIFY(SCHEMA_VERSION) ";"
+                "COMMIT;";
     char* err_msg = 0;
-    char sql[600];
-
-    // convert to 24-hour format
-    char start_24[MAX_TIME_LENGTH], end_24[MAX_TIME_LENGTH];
-    format_time_24hour((char*)start_time, start_24);
-    format_time_24hour((char*)end_time, end_24);
+    int rc = sqlite3_exec(bs->db, sql, 0, 0, &err_msg);
 
-    //CHECK FOR CONFLICT BEFORE INSERTING
-    if (check_time_conflict(date, start_24, end_24, consultation_room)) {
-        fprintf(stderr, "Reservation conflict detected. Room %s is already booked on %s between %s and %s.\n", consultation_room, date, start_time, end_time);
+    if (rc != SQLITE_OK) {
+        fprintf(stderr, "SQL error: %s\n", err_msg);
+        sqlite3_free(err_msg);
+        sqlite3_exec(bs->db, "ROLLBACK;", 0, 0, 0);
         return 1;
     }
 
-    //INSERT RESERVATION IF NO CONFLICT
-    sprintf(sql, "INSERT INTO reservations (student_name, student_num, date, start_time, end_time, reservation_id, consultation_room) "
-                 "VALUES ('%s', '%s', '%s', '%s', '%s', '%s', '%s');",
-                 name, student_num, date, start_24, end_24, reservation_id, consultation_room);
-
-    int rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
+    // Composite indexes matched to the statement registry. The implicit
+    // UNIQUE(day, start_min, end_min, room_id) index already serves the
+    // by-date schedule and the full ORDER BY day, start_min listing.
+    //  - room + day + start: conflict check (equality on room and day, range on start_min),
+    //    covering end_min and reservation_id so the count never reads the table
+    //  - student_num + day + start: lookups by student number, already in output order
+    char* index_sql =
+        "CREATE INDEX IF NOT EXISTS idx_reservations_room_day_start "
+        "ON reservations(room_id, day, start_min, end_min, reservation_id);"
+        "CREATE INDEX IF NOT EXISTS idx_reservations_student_day_start "
+        "ON reservations(student_num, day, start_min);";
+    rc = sqlite3_exec(bs->db, index_sql, 0, 0, &err_msg);
 
     if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
+        fprintf(stderr, "SQL error while creating indexes: %s\n", err_msg);
         sqlite3_free(err_msg);
         return 1;
     }
+    return create_name_index(bs);
+}
 
+// Drops the caches if another connection (another terminal) committed since we last looked.
+// Our own commits do not change data_version, so the caches survive them.
+static int sync_caches(Bookspace* bs) {
+    sqlite3_stmt* stmt = get_statement(bs, STMT_DATA_VERSION);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        sqlite3_reset(stmt);
+        return 1;
+    }
+    sqlite3_int64 version = sqlite3_column_int64(stmt, 0);
+    sqlite3_reset(stmt);
+
+    if (version != bs->cached_data_version) {
+        // Another connection may also have added rooms; reloading drops both caches
+        bs->cached_data_version = version;
+        return load_rooms(bs);
+    }
     return 0;
 }
 
-int delete_reservation(const char* reservation_id) {
-        char sql[200];
-        char* err_msg = 0;
+// Steps BEGIN/COMMIT, retrying with backoff while another connection holds the lock.
+// Returns 0, or the SQLite result code of the last attempt.
+static int step_with_retry(Bookspace* bs, StatementId id) {
+    int delay = WRITE_RETRY_DELAY_MS;
+
+    for (int attempt = 1; ; attempt++) {
+        sqlite3_stmt* stmt = get_statement(bs, id);
+        int rc = sqlite3_step(stmt);
+        if (rc == SQLITE_DONE) {
+            sqlite3_reset(stmt);
+            return 0;
+        }
+        if ((rc != SQLITE_BUSY && rc != SQLITE_LOCKED) || attempt >= WRITE_RETRY_LIMIT) {
+            fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+            sqlite3_reset(stmt);
+            return rc;
+        }
+        sqlite3_reset(stmt);
+        sqlite3_sleep(delay);
+        delay *= 2;
+    }
+}
 
-        sprintf(sql, "DELETE FROM reservations WHERE reservation_id = '%s';", reservation_id);
-        //printf("DEBUG - Executing SQL: %s\n", sql);
-       //printf("DEBUG - Reservation ID length: %zu\n", strlen(reservation_id));
+// Result for a failed SQLite call: lock timeouts are reported separately so callers can retry
+static BookspaceResult failure_result(int rc) {
+    return (rc == SQLITE_BUSY || rc == SQLITE_LOCKED) ? BOOKSPACE_BUSY : BOOKSPACE_ERROR;
+}
 
-        int rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
+// Commits (ok = 1) or rolls back a transaction opened by write_begin
+static BookspaceResult write_end(Bookspace* bs, int owned, int ok) {
+    if (!owned) {
+        return ok ? BOOKSPACE_OK : BOOKSPACE_ERROR;
+    }
+    int rc = SQLITE_ERROR;
+    if (ok && (rc = step_with_retry(bs, STMT_COMMIT)) == 0) {
+        note_commit(bs);
+        return BOOKSPACE_OK;
+    }
+    if (!sqlite3_get_autocommit(bs->db)) {
+        sqlite3_stmt* stmt = get_statement(bs, STMT_ROLLBACK);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    return failure_result(rc);
+}
 
-        if (rc != SQLITE_OK) {
-            fprintf(stderr, "SQL error: %s\n", err_msg);
-            sqlite3_free(err_msg);
-            return -1;
+// Opens the write transaction that makes conflict check + write atomic. BEGIN IMMEDIATE takes
+// the write lock up front, so no other terminal can book between our check and our write.
+// If the caller already has a transaction open (a bulk import batch) it is reused and
+// *owned is 0, leaving commit/rollback to the caller.
+static BookspaceResult write_begin(Bookspace* bs, int* owned) {
+    *owned = sqlite3_get_autocommit(bs->db);
+    if (!*owned) {
+        return BOOKSPACE_OK; // caches were synced when the caller's transaction began
+    }
+    int rc = step_with_retry(bs, STMT_BEGIN_IMMEDIATE);
+    if (rc != 0) {
+        return failure_result(rc);
+    }
+    // Holding the write lock, so the caches can be trusted once they are in sync
+    if (sync_caches(bs) != 0) {
+        write_end(bs, *owned, 0);
+        return BOOKSPACE_ERROR;
+    }
+    return BOOKSPACE_OK;
+}
+
+// Counts reservations overlapping [start_min, end_min) in the same room, ignoring exclude_id
+static int count_conflicts(Bookspace* bs, int day, int start_min, int end_min, int room, const char* exclude_id) {
+    sqlite3_stmt* stmt = get_statement(bs, STMT_CHECK_CONFLICT);
+    sqlite3_bind_int(stmt, 1, day);
+    sqlite3_bind_int(stmt, 2, bs->catalog.rooms[room].id);
+    sqlite3_bind_int(stmt, 3, start_min);
+    sqlite3_bind_int(stmt, 4, end_min);
+    if (exclude_id) {
+        bind_text(stmt, 5, exclude_id);
+    }
+    return step_count(stmt);
+}
+
+// Returns the cached intervals of (room, day), loading them from the database when cold.
+// NULL if the load failed; callers then use SQL.
+static IntervalList* day_intervals(Bookspace* bs, int room, int day) {
+    IntervalList* list = interval_index_find(&bs->interval_cache, room, day);
+    if (list) return list;
+
+    list = interval_index_create(&bs->interval_cache, room, day);
+    if (!list) return NULL;
+
+    sqlite3_stmt* stmt = get_statement(bs, STMT_DAY_INTERVALS);
+    sqlite3_bind_int(stmt, 1, bs->catalog.rooms[room].id);
+    sqlite3_bind_int(stmt, 2, day);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (interval_list_add(list, sqlite3_column_int(stmt, 0), sqlite3_column_int(stmt, 1)) != 0) {
+            rc = SQLITE_NOMEM;
+            break;
         }
+    }
+    sqlite3_reset(stmt);
 
-        int changes = sqlite3_changes(db);
-        
-        if (changes == 0) {
-            return 1;
+    if (rc != SQLITE_DONE) {
+        // Never leave a half-loaded key behind
+        interval_index_clear(&bs->interval_cache);
+        return NULL;
+    }
+    return list;
+}
+
+// Same as count_conflicts but answered from the interval cache when possible.
+// ignore_* describe the reservation's own current slot when editing (ignore_room -1 = none).
+static int slot_conflicts(Bookspace* bs, int day, int start_min, int end_min, int room,
+                          const char* exclude_id, int ignore_room, int ignore_day, int ignore_start, int ignore_end) {
+    IntervalList* list = day_intervals(bs, room, day);
+    if (!list) {
+        return count_conflicts(bs, day, start_min, end_min, room, exclude_id);
+    }
+
+    int own_slot = ignore_room == room && ignore_day == day
+                   && interval_list_remove(list, ignore_start, ignore_end) == 0;
+    int conflict = interval_list_overlaps(list, start_min, end_min);
+    if (own_slot) {
+        interval_list_add(list, ignore_start, ignore_end);
+    }
+    return conflict;
+}
+
+// Mirrors a committed write in the caches; keys that are still cold are left alone
+static void cache_slot_added(Bookspace* bs, int room, int day, int start_min, int end_min) {
+    IntervalList* list = room < 0 ? NULL : interval_index_find(&bs->interval_cache, room, day);
+    if (list && interval_list_add(list, start_min, end_min) != 0) {
+        interval_index_clear(&bs->interval_cache);
+    }
+
+    DayAvailability* avail = availability_cache_find(&bs->availability_cache, day);
+    if (avail && room >= 0 && room < avail->room_count) {
+        day_availability_mark(avail, room, start_min, end_min);
+    }
+}
+
+static void cache_slot_removed(Bookspace* bs, int room, int day, int start_min, int end_min) {
+    IntervalList* list = room < 0 ? NULL : interval_index_find(&bs->interval_cache, room, day);
+    if (list) {
+        interval_list_remove(list, start_min, end_min);
+    }
+
+    // A slot bit may be shared with a neighbouring booking, so rebuild instead of clearing it
+    availability_cache_drop(&bs->availability_cache, day);
+}
+
+// Slot bitmaps of every room for day, loaded with one query when not cached. The time
+// outside a room's open hours is marked busy, so every bitmap query respects room hours.
+static DayAvailability* day_availability(Bookspace* bs, int day) {
+    if (sync_caches(bs) != 0) return NULL;
+
+    DayAvailability* avail = availability_cache_find(&bs->availability_cache, day);
+    if (avail) return avail;
+
+    avail = availability_cache_slot(&bs->availability_cache, day, bs->catalog.count);
+    if (!avail) return NULL;
+
+    for (int r = 0; r < bs->catalog.count; r++) {
+        const Room* room = &bs->catalog.rooms[r];
+        day_availability_mark(avail, r, LIBRARY_OPEN_MINUTES, room->open_min);
+        day_availability_mark(avail, r, room->close_min, LIBRARY_CLOSE_MINUTES);
+    }
+
+    sqlite3_stmt* stmt = get_statement(bs, STMT_DAY_BOOKINGS);
+    sqlite3_bind_int(stmt, 1, day);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        // No reload on a miss: that would free avail. sync_caches has the current catalog.
+        int room = room_index_of_id(&bs->catalog, sqlite3_column_int(stmt, 0));
+        if (room >= 0) {
+            day_availability_mark(avail, room, sqlite3_column_int(stmt, 1), sqlite3_column_int(stmt, 2));
         }
+    }
+    sqlite3_reset(stmt);
 
-        return 0;
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        availability_cache_drop(&bs->availability_cache, day);
+        return NULL;
     }
+    return avail;
+}
 
-    int reservation_exists(const char* reservation_id) {
-    char sql[200];
-    char* err_msg = 0;
-    int count = 0;
+// 1 if [start_min, end_min) is free in the room, 0 if booked, -1 on error
+int slot_available(Bookspace* bs, int day, int start_min, int end_min, int room) {
+    if (sync_caches(bs) != 0) {
+        return -1;
+    }
 
-    sprintf(sql, "SELECT COUNT(*) FROM reservations WHERE reservation_id = '%s';", reservation_id);
-    
-    int rc = sqlite3_exec(db, sql, callback_count_reservations, &count, &err_msg);
-    
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
-        return -1; // Error
+    // Only check conflicts within the SAME room
+    int conflict = slot_conflicts(bs, day, start_min, end_min, room, NULL, -1, 0, 0, 0);
+    if (conflict < 0) {
+        return -1;
     }
-    
-    return count > 0 ? 1 : 0; // 1 = exists, 0 = doesn't exist
+    return conflict == 0;
 }
 
-int update_reservation(const char* reservation_id, const char* name, const char* student_num, 
-                       const char* date, const char* start_time, const char* end_time, 
-                       const char* consultation_room) {
-    char sql[600];
-    char* err_msg = 0;
+BookspaceResult insert_reservation_slot(Bookspace* bs, const char* name, const char* student_num, int day, int start_min, int end_min,
+                                        const char* reservation_id, int room) {
+    // Conflict check and insert run in one IMMEDIATE transaction (or the caller's batch)
+    int owned;
+    BookspaceResult result = write_begin(bs, &owned);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
 
-    // Convert time inputs to 24-hour format
-    char start_24[MAX_TIME_LENGTH], end_24[MAX_TIME_LENGTH];
-    format_time_24hour((char*)start_time, start_24);
-    format_time_24hour((char*)end_time, end_24);
+    //CHECK FOR CONFLICT BEFORE INSERTING
+    int conflicts = slot_conflicts(bs, day, start_min, end_min, room, NULL, -1, 0, 0, 0);
+    if (conflicts != 0) {
+        write_end(bs, owned, 0);
+        return conflicts > 0 ? BOOKSPACE_CONFLICT : BOOKSPACE_ERROR;
+    }
 
-    // Check for time conflicts before updating
-    if (check_time_conflict(date, start_24, end_24, consultation_room)) {
-        fprintf(stderr, "Time conflict detected. Room %s is already booked on %s between %s and %s.\n",
-                consultation_room, date, start_time, end_time);
-        return 1;
+    //INSERT RESERVATION IF NO CONFLICT
+    sqlite3_stmt* stmt = get_statement(bs, STMT_INSERT_RESERVATION);
+    bind_text(stmt, 1, name);
+    bind_text(stmt, 2, student_num);
+    sqlite3_bind_int(stmt, 3, day);
+    sqlite3_bind_int(stmt, 4, start_min);
+    sqlite3_bind_int(stmt, 5, end_min);
+    bind_text(stmt, 6, reservation_id);
+    sqlite3_bind_int(stmt, 7, bs->catalog.rooms[room].id);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc == SQLITE_CONSTRAINT) {
+        // Only the reservation_id UNIQUE can fire here: same-slot duplicates overlap and were caught above
+        write_end(bs, owned, 0);
+        return BOOKSPACE_DUPLICATE_ID;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+    }
+    result = write_end(bs, owned, rc == SQLITE_DONE);
+    if (result != BOOKSPACE_OK) {
+        return result;
     }
 
-    // Prepare SQL update query
-    sprintf(sql,
-        "UPDATE reservations SET "
-        "student_name = '%s', "
-        "student_num = '%s', "
-        "date = '%s', "
-        "start_time = '%s', "
-        "end_time = '%s', "
-        "consultation_room = '%s' "
-        "WHERE reservation_id = '%s';",
-        name, student_num, date, start_24, end_24, consultation_room, reservation_id);
+    cache_slot_added(bs, room, day, start_min, end_min);
+    return BOOKSPACE_OK;
+}
 
-    // Execute update query
-    int rc = sqlite3_exec(db, sql, 0, 0, &err_msg);
+// Adds a room to the table and the end of the catalog (ids only grow, so the catalog
+// stays sorted). Hours are minutes since midnight within library hours.
+BookspaceResult insert_room(Bookspace* bs, const char* name, int capacity, int open_min, int close_min, int* room_out) {
+    int owned;
+    BookspaceResult result = write_begin(bs, &owned);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error while updating reservation: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    sqlite3_stmt* stmt = get_statement(bs, STMT_INSERT_ROOM);
+    bind_text(stmt, 1, name);
+    sqlite3_bind_int(stmt, 2, capacity);
+    sqlite3_bind_int(stmt, 3, open_min);
+    sqlite3_bind_int(stmt, 4, close_min);
+
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc == SQLITE_CONSTRAINT) {
+        // The UNIQUE name; capacity and hours were validated by the caller
+        write_end(bs, owned, 0);
+        return BOOKSPACE_DUPLICATE_ROOM;
+    }
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+    }
+    int id = (int)sqlite3_last_insert_rowid(bs->db);
+    result = write_end(bs, owned, rc == SQLITE_DONE);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+
+    RoomCatalog* catalog = &bs->catalog;
+    if (catalog->count == catalog->capacity || (catalog->count > 0 && catalog->rooms[catalog->count - 1].id > id)) {
+        // Full, or another program inserted out of order: read the table back
+        if (load_rooms(bs) != 0) return BOOKSPACE_ERROR;
+    } else {
+        Room* room = &catalog->rooms[catalog->count++];
+        room->id = id;
+        snprintf(room->name, sizeof(room->name), "%s", name);
+        room->capacity = capacity;
+        room->open_min = open_min;
+        room->close_min = close_min;
+        // Cached bitmaps are sized for the old room count
+        availability_cache_free(&bs->availability_cache);
+    }
+    if (room_out) *room_out = room_index_of_id(catalog, id);
+    return BOOKSPACE_OK;
+}
+
+// Batched writes (bulk import): one IMMEDIATE transaction spans many insert_reservation_slot(bs) calls
+int begin_batch(Bookspace* bs) {
+    if (step_with_retry(bs, STMT_BEGIN_IMMEDIATE) != 0) {
         return 1;
     }
+    if (sync_caches(bs) != 0) {
+        rollback_batch(bs);
+        return 1;
+    }
+    return 0;
+}
 
-    printf("Reservation [%s] updated successfully.\n", reservation_id);
+int commit_batch(Bookspace* bs) {
+    if (step_with_retry(bs, STMT_COMMIT) != 0) {
+        rollback_batch(bs);
+        return 1;
+    }
+    note_commit(bs);
     return 0;
 }
 
-int get_reservations_by_date(const char* date) {
-    char sql[200];
-    char* err_msg = 0;
+void rollback_batch(Bookspace* bs) {
+    if (!sqlite3_get_autocommit(bs->db)) {
+        sqlite3_stmt* stmt = get_statement(bs, STMT_ROLLBACK);
+        sqlite3_step(stmt);
+        sqlite3_reset(stmt);
+    }
+    // The caches already hold the batch's rows, and the catalog any rooms it added;
+    // reloading the catalog drops both caches
+    load_rooms(bs);
+}
 
-    sprintf(sql, "SELECT * FROM reservations WHERE date = '%s' ORDER BY start_time;", date);
+BookspaceResult delete_reservation(Bookspace* bs, const char* reservation_id) {
+    int owned;
+    BookspaceResult result = write_begin(bs, &owned);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
 
-    int rc = sqlite3_exec(db, sql, callback_print_reservations, 0, &err_msg);
+    sqlite3_stmt* stmt = get_statement(bs, STMT_DELETE_RESERVATION);
+    bind_text(stmt, 1, reservation_id);
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
-        return 1;
+    // reservation_id is UNIQUE, so at most one row comes back
+    int room_id = 0;
+    int day = 0, start_min = 0, end_min = 0;
+    int deleted = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        room_id = sqlite3_column_int(stmt, 0);
+        day = sqlite3_column_int(stmt, 1);
+        start_min = sqlite3_column_int(stmt, 2);
+        end_min = sqlite3_column_int(stmt, 3);
+        deleted++;
     }
 
-    return 0;
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+    }
+    sqlite3_reset(stmt);
+
+    result = write_end(bs, owned, rc == SQLITE_DONE);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+
+    if (deleted == 0) {
+        return BOOKSPACE_NOT_FOUND;
+    }
+
+    cache_slot_removed(bs, room_index_of_id(&bs->catalog, room_id), day, start_min, end_min);
+    return BOOKSPACE_OK;
 }
 
-int get_reservations_by_student_num(const char* student_num) {
-    char sql[200];
-    char* err_msg = 0;
+int reservation_exists(Bookspace* bs, const char* reservation_id) {
+    sqlite3_stmt* stmt = get_statement(bs, STMT_RESERVATION_EXISTS);
+    bind_text(stmt, 1, reservation_id);
 
-    sprintf(sql, "SELECT * FROM reservations WHERE student_num = '%s' ORDER BY date, start_time;", student_num);
+    int count = step_count(stmt);
 
-    int rc = sqlite3_exec(db, sql, callback_print_reservations, 0, &err_msg);
+    if (count < 0) {
+        return -1; // Error
+    }
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    return count > 0 ? 1 : 0; // 1 = exists, 0 = doesn't exist
+}
+
+BookspaceResult update_reservation_slot(Bookspace* bs, const char* reservation_id, const char* name, const char* student_num,
+                                        int day, int start_min, int end_min, int room) {
+    // Reading the old slot, the conflict check and the update run in one IMMEDIATE transaction
+    int owned;
+    BookspaceResult result = write_begin(bs, &owned);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+
+    // Current slot of the reservation, so it does not conflict with itself
+    int old_room = -1;
+    int old_day = 0, old_start = 0, old_end = 0;
+    sqlite3_stmt* slot = get_statement(bs, STMT_RESERVATION_SLOT);
+    bind_text(slot, 1, reservation_id);
+    int rc = sqlite3_step(slot);
+    if (rc != SQLITE_ROW) {
+        if (rc != SQLITE_DONE) fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        sqlite3_reset(slot);
+        write_end(bs, owned, 0);
+        return rc == SQLITE_DONE ? BOOKSPACE_NOT_FOUND : BOOKSPACE_ERROR;
+    }
+    old_room = room_index_of_id(&bs->catalog, sqlite3_column_int(slot, 0));
+    old_day = sqlite3_column_int(slot, 1);
+    old_start = sqlite3_column_int(slot, 2);
+    old_end = sqlite3_column_int(slot, 3);
+    sqlite3_reset(slot);
+
+    // Check for time conflicts before updating
+    int conflicts = slot_conflicts(bs, day, start_min, end_min, room, reservation_id,
+                                   old_room, old_day, old_start, old_end);
+    if (conflicts != 0) {
+        write_end(bs, owned, 0);
+        return conflicts > 0 ? BOOKSPACE_CONFLICT : BOOKSPACE_ERROR;
+    }
+
+    sqlite3_stmt* stmt = get_statement(bs, STMT_UPDATE_RESERVATION);
+    bind_text(stmt, 1, name);
+    bind_text(stmt, 2, student_num);
+    sqlite3_bind_int(stmt, 3, day);
+    sqlite3_bind_int(stmt, 4, start_min);
+    sqlite3_bind_int(stmt, 5, end_min);
+    sqlite3_bind_int(stmt, 6, bs->catalog.rooms[room].id);
+    bind_text(stmt, 7, reservation_id);
+
+    result = write_end(bs, owned, step_done(stmt) == 0);
+    if (result != BOOKSPACE_OK) {
+        return result;
+    }
+
+    cache_slot_removed(bs, old_room, old_day, old_start, old_end);
+    cache_slot_added(bs, room, day, start_min, end_min);
+    return BOOKSPACE_OK;
+}
+
+// Streaming queries: each cursor borrows its cached statement, so at most one cursor
+// per query kind can be open at a time and it must be closed before the query is reused.
+int reservation_cursor_by_day(Bookspace* bs, ReservationCursor* cursor, int day) {
+    sqlite3_stmt* stmt = get_statement(bs, STMT_RESERVATIONS_BY_DATE);
+    sqlite3_bind_int(stmt, 1, day);
+    return open_cursor(bs, cursor, stmt, STATS_OP_LIST);
+}
+
+int reservation_cursor_by_date(Bookspace* bs, ReservationCursor* cursor, const char* date) {
+    int day = date_to_day_number(date);
+    if (day < 0) {
+        cursor->stmt = NULL;
+        cursor->op = -1;
         return 1;
     }
+    return reservation_cursor_by_day(bs, cursor, day);
+}
 
-    return 0;
+int reservation_cursor_by_student_num(Bookspace* bs, ReservationCursor* cursor, const char* student_num) {
+    sqlite3_stmt* stmt = get_statement(bs, STMT_RESERVATIONS_BY_STUDENT_NUM);
+    bind_text(stmt, 1, student_num);
+    return open_cursor(bs, cursor, stmt, STATS_OP_SEARCH);
 }
 
-int get_reservations_by_id(const char* reservation_id) {
-    char sql[200];
-    char* err_msg = 0;
+int reservation_cursor_by_id(Bookspace* bs, ReservationCursor* cursor, const char* reservation_id) {
+    sqlite3_stmt* stmt = get_statement(bs, STMT_RESERVATIONS_BY_ID);
+    bind_text(stmt, 1, reservation_id);
+    return open_cursor(bs, cursor, stmt, STATS_OP_SEARCH);
+}
 
-    sprintf(sql, "SELECT * FROM reservations WHERE reservation_id = '%s';", reservation_id);
+int reservation_cursor_by_name(Bookspace* bs, ReservationCursor* cursor, const char* name) {
+    // Characters, not bytes: UTF-8 continuation bytes are 10xxxxxx
+    int chars = 0;
+    for (const unsigned char* p = (const unsigned char*)name; *p; p++) {
+        if ((*p & 0xC0) != 0x80) chars++;
+    }
+    StatementId id = STMT_RESERVATIONS_BY_NAME;
+    if (chars >= NAME_INDEX_MIN_CHARS && bs->statements[STMT_RESERVATIONS_BY_NAME_INDEX]) {
+        id = STMT_RESERVATIONS_BY_NAME_INDEX;
+    }
+    sqlite3_stmt* stmt = get_statement(bs, id);
+    bind_text(stmt, 1, name);
+    return open_cursor(bs, cursor, stmt, STATS_OP_SEARCH);
+}
 
-    int rc = sqlite3_exec(db, sql, callback_print_reservations, 0, &err_msg);
+int reservation_cursor_all(Bookspace* bs, ReservationCursor* cursor) {
+    return open_cursor(bs, cursor, get_statement(bs, STMT_ALL_RESERVATIONS), STATS_OP_LIST);
+}
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
-        return 1;
+static const char* column_text(sqlite3_stmt* stmt, int column) {
+    const char* text = (const char*)sqlite3_column_text(stmt, column);
+    return text ? text : "";
+}
+
+int reservation_cursor_next(ReservationCursor* cursor, ReservationRow* row) {
+    if (!cursor->stmt || cursor->done) {
+        return 0;
     }
 
-    return 0;
+    int rc = sqlite3_step(cursor->stmt);
+    if (rc == SQLITE_DONE) {
+        cursor->done = 1;
+        finish_cursor_op(cursor);
+        return 0;
+    }
+    if (rc != SQLITE_ROW) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(sqlite3_db_handle(cursor->stmt)));
+        cursor->done = 1;
+        finish_cursor_op(cursor);
+        return -1;
+    }
+
+    // Column order: RESERVATION_COLUMNS
+    sqlite3_stmt* stmt = cursor->stmt;
+    row->id = sqlite3_column_int(stmt, 0);
+    row->name = column_text(stmt, 1);
+    row->student_num = column_text(stmt, 2);
+    row->day = sqlite3_column_int(stmt, 3);
+    row->start_min = sqlite3_column_int(stmt, 4);
+    row->end_min = sqlite3_column_int(stmt, 5);
+    row->reservation_id = column_text(stmt, 6);
+    row->room = room_of_id(cursor->bs, sqlite3_column_int(stmt, 7));
+    row->consultation_room = row->room >= 0 ? cursor->bs->catalog.rooms[row->room].name : "";
+    row->created_at = column_text(stmt, 8);
+    return 1;
 }
 
-int get_all_reservations() {
-    char* sql = "SELECT * FROM reservations ORDER BY date, start_time;";
-    char* err_msg = 0;
+static void copy_field(char* dest, size_t size, const char* src) {
+    strncpy(dest, src, size - 1);
+    dest[size - 1] = '\0';
+}
 
-    int rc = sqlite3_exec(db, sql, callback_print_reservations, 0, &err_msg);
+int reservation_cursor_read(ReservationCursor* cursor, Reservation* out) {
+    ReservationRow row;
+    int rc = reservation_cursor_next(cursor, &row);
+    if (rc != 1) {
+        return rc;
+    }
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
+    out->id = row.id;
+    copy_field(out->name, sizeof(out->name), row.name);
+    copy_field(out->student_num, sizeof(out->student_num), row.student_num);
+    day_number_to_date(row.day, out->date);
+    minutes_to_time_24hour(row.start_min, out->start_time);
+    minutes_to_time_24hour(row.end_min, out->end_time);
+    copy_field(out->reservation_id, sizeof(out->reservation_id), row.reservation_id);
+    copy_field(out->consultation_room, sizeof(out->consultation_room), row.consultation_room);
+    return 1;
+}
+
+void reservation_cursor_close(ReservationCursor* cursor) {
+    if (cursor->stmt) {
+        sqlite3_reset(cursor->stmt);
+        cursor->stmt = NULL;
+        finish_cursor_op(cursor);
+    }
+}
+
+int for_each_reservation(ReservationCursor* cursor, ReservationVisitor visit, void* data) {
+    ReservationRow row;
+    int rc;
+
+    if (!cursor->stmt) {
         return 1;
     }
+    while ((rc = reservation_cursor_next(cursor, &row)) == 1) {
+        if (visit(&row, data) != 0) {
+            break;
+        }
+    }
+    reservation_cursor_close(cursor);
+    return rc < 0 ? 1 : 0;
+}
 
-    return 0;
+// Availability queries. The slot bitmaps (see availability.h) round partly covered 5-minute
+// slots up to busy, so they only prefilter; answers are exact to the minute.
+
+// Exact check of a room the bitmap reported busy for [start_min, end_min). Slots wholly
+// inside the range are exact, so only a hit confined to the two boundary slots needs the
+// room's intervals. 1 free, 0 busy, -1 error.
+static int room_free_exact(Bookspace* bs, const DayAvailability* avail, int day, int room, int start_min, int end_min) {
+    const Room* info = &bs->catalog.rooms[room];
+    if (start_min < info->open_min || end_min > info->close_min) {
+        return 0;
+    }
+    int inner_start = LIBRARY_OPEN_MINUTES + (start_min - LIBRARY_OPEN_MINUTES + SLOT_MINUTES - 1) / SLOT_MINUTES * SLOT_MINUTES;
+    int inner_end = LIBRARY_OPEN_MINUTES + (end_min - LIBRARY_OPEN_MINUTES) / SLOT_MINUTES * SLOT_MINUTES;
+    if (inner_start < inner_end && !availability_range_free(avail, room, inner_start, inner_end)) {
+        return 0;
+    }
+    // slot_conflicts, not slot_available: a cache sync here could free avail
+    int conflict = slot_conflicts(bs, day, start_min, end_min, room, NULL, -1, 0, 0, 0);
+    return conflict < 0 ? -1 : conflict == 0;
 }
 
-int get_reservations_by_name(const char* name) {
-    char sql[300];
-    char* err_msg = 0;
+// Catalog indexes of the rooms open and free for the whole range, in index order
+int free_rooms(Bookspace* bs, int day, int start_min, int end_min, int* rooms_out) {
+    DayAvailability* avail = day_availability(bs, day);
+    if (!avail) {
+        return -1;
+    }
+    int* passed = malloc(((size_t)avail->room_count + 1) * sizeof(*passed));
+    if (!passed) {
+        return -1;
+    }
+    int passed_count = availability_free_rooms(avail, start_min, end_min, passed);
 
-    sprintf(sql, "SELECT * FROM reservations WHERE student_name LIKE '%%%s%%' ORDER BY date, start_time;", name);
+    // Rooms that pass the bitmap are free; the rest get the exact check
+    int count = 0;
+    for (int r = 0, i = 0; r < avail->room_count; r++) {
+        int free = 1;
+        if (i < passed_count && passed[i] == r) {
+            i++;
+        } else if ((free = room_free_exact(bs, avail, day, r, start_min, end_min)) < 0) {
+            count = -1;
+            break;
+        }
+        if (free) {
+            if (rooms_out) rooms_out[count] = r;
+            count++;
+        }
+    }
+    free(passed);
+    return count;
+}
 
-    int rc = sqlite3_exec(db, sql, callback_print_reservations, 0, &err_msg);
+// Earliest start at or after from_min of duration_min free minutes within the room's hours,
+// walking the day's intervals in start order. -1 none, -2 error.
+static int room_first_window(Bookspace* bs, int day, int from_min, int duration_min, int room) {
+    const Room* info = &bs->catalog.rooms[room];
+    IntervalList* list = day_intervals(bs, room, day);
+    if (!list) {
+        return -2;
+    }
+    int start = from_min > info->open_min ? from_min : info->open_min;
+    for (int i = 0; i < list->count; i++) {
+        if (list->intervals[i].start_min >= start + duration_min) {
+            break; // every later interval starts later still
+        }
+        if (list->intervals[i].end_min > start) {
+            start = list->intervals[i].end_min;
+        }
+    }
+    return start + duration_min <= info->close_min ? start : -1;
+}
 
-    if (rc != SQLITE_OK) {
-        fprintf(stderr, "SQL error: %s\n", err_msg);
-        sqlite3_free(err_msg);
+// room -1 = the earliest window in any room, ties to the lowest index
+int first_free_window(Bookspace* bs, int day, int from_min, int duration_min, int room, int* room_out) {
+    if (sync_caches(bs) != 0 || room >= bs->catalog.count) {
+        return -2;
+    }
+    int best = -1;
+    int first = room < 0 ? 0 : room;
+    int last = room < 0 ? bs->catalog.count - 1 : room;
+    for (int r = first; r <= last; r++) {
+        int start = room_first_window(bs, day, from_min, duration_min, r);
+        if (start < -1) {
+            return -2;
+        }
+        if (start >= 0 && (best < 0 || start < best)) {
+            best = start;
+            if (room_out) *room_out = r;
+        }
+    }
+    return best;
+}
+
+// One day of the free/busy grid: fills step_min-wide cells of library hours for each room
+// in rooms, room after room. The day's bitmaps come from a single ordered scan of the
+// (day, start_min, ...) index, and step_min is a multiple of SLOT_MINUTES, so cell
+// boundaries fall on slot boundaries and the bitmap answer is exact.
+int availability_grid_day(Bookspace* bs, int day, const int* rooms, int room_count, int step_min, char* cells) {
+    DayAvailability* avail = day_availability(bs, day);
+    if (!avail) {
         return 1;
     }
+    int cells_per_day = (LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES + step_min - 1) / step_min;
 
+    for (int i = 0; i < room_count; i++) {
+        if (rooms[i] < 0 || rooms[i] >= avail->room_count) {
+            return 1;
+        }
+        const Room* room = &bs->catalog.rooms[rooms[i]];
+        char* row = cells + (size_t)i * cells_per_day;
+        for (int c = 0; c < cells_per_day; c++) {
+            int start = LIBRARY_OPEN_MINUTES + c * step_min;
+            int end = start + step_min < LIBRARY_CLOSE_MINUTES ? start + step_min : LIBRARY_CLOSE_MINUTES;
+            if (end <= room->open_min || start >= room->close_min) {
+                row[c] = GRID_CLOSED;
+            } else {
+                row[c] = availability_range_free(avail, rooms[i], start, end) ? GRID_FREE : GRID_BUSY;
+            }
+        }
+    }
     return 0;
 }
 
-// Callback implementations
-int callback_print_reservations(void* data, int argc, char** argv, char** azColName) {
-    (void)data;
-    (void)azColName;
-    
-    // Format: reservation_id | start_time | end_time | student_name
-    // Column order: id(0), student_name(1), student_num(2), date(3), start_time(4), end_time(5), reservation_id(6), consultation_room(7), created_at(8)
-    if (argc >= 8) {
-        const char* reservation_id = argv[6] ? argv[6] : "NULL";
-        const char* date = argv[3] ? argv[3] : "NULL";
-        const char* student_name = argv[1] ? argv[1] : "NULL";
-        const char* consultation_room = argv[7] ? argv[7] : "NULL";
-        const char* start_time = argv[4] ? argv[4] : "NULL";
-        const char* end_time = argv[5] ? argv[5] : "NULL";
-        
-        // Convert 24-hour times back to 12-hour format for display
-        char start_12[MAX_TIME_LENGTH], end_12[MAX_TIME_LENGTH];
-        format_time_12hour((char*)start_time, start_12);
-        format_time_12hour((char*)end_time, end_12);
-        
-        printf("| %-20s | %-10s | %-15s | %-10s | %-10s | %-25s |\n", 
-               reservation_id, date, consultation_room, start_12, end_12, student_name);
+// Appends [start_min, end_min) to out if it holds duration_min; returns the new count
+static int add_gap(FreeGap* out, int count, int room, int day, int start_min, int end_min, int duration_min) {
+    if (end_min - start_min >= duration_min) {
+        FreeGap gap = { room, day, start_min, end_min };
+        out[count++] = gap;
     }
-    return 0;
+    return count;
 }
 
-int callback_count_reservations(void* data, int argc, char** argv, char** azColName) {
-    (void)azColName;
-    if (argc > 0 && argv && argv[0]) {
-        int* out = (int*)data;
-        *out = atoi(argv[0]);
+// The first max_gaps free gaps of at least duration_min in one room, from from_min on
+// first_day through last_day, within the room's open hours. Walks the room's bookings in
+// (day, start_min) order with one streamed index scan, keeping the end of the busy time
+// seen so far; every day without bookings is one whole gap. Stops as soon as max_gaps are
+// found, so the cost is linear in the bookings read. Returns the count, -1 on error.
+int room_free_gaps(Bookspace* bs, int room, int first_day, int from_min, int last_day, int duration_min,
+                   FreeGap* out, int max_gaps) {
+    if (room < 0 || room >= bs->catalog.count) {
+        return -1;
     }
-    return 0;
-}
\ No newline at end of file
+    const Room* info = &bs->catalog.rooms[room];
+    sqlite3_stmt* stmt = get_statement(bs, STMT_ROOM_BOOKINGS);
+    sqlite3_bind_int(stmt, 1, info->id);
+    sqlite3_bind_int(stmt, 2, first_day);
+    sqlite3_bind_int(stmt, 3, last_day);
+
+    int count = 0;
+    int day = first_day;
+    int free_from = from_min > info->open_min ? from_min : info->open_min;
+    int rc = SQLITE_DONE;
+    while (count < max_gaps && (rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        int booking_day = sqlite3_column_int(stmt, 0);
+        int start_min = sqlite3_column_int(stmt, 1);
+        int end_min = sqlite3_column_int(stmt, 2);
+
+        // Close the days before this booking
+        while (day < booking_day && count < max_gaps) {
+            count = add_gap(out, count, room, day, free_from, info->close_min, duration_min);
+            day++;
+            free_from = info->open_min;
+        }
+        if (count == max_gaps) break;
+
+        if (start_min > free_from) {
+            int gap_end = start_min < info->close_min ? start_min : info->close_min;
+            count = add_gap(out, count, room, day, free_from, gap_end, duration_min);
+        }
+        if (end_min > free_from) {
+            free_from = end_min;
+        }
+    }
+    sqlite3_reset(stmt);
+
+    if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
+        fprintf(stderr, "SQL error: %s\n", sqlite3_errmsg(bs->db));
+        return -1;
+    }
+    // Past the last booking: the rest of this day, then whole days up to the horizon
+    while (day <= last_day && count < max_gaps) {
+        count = add_gap(out, count, room, day, free_from, info->close_min, duration_min);
+        day++;
+        free_from = info->open_min;
+    }
+    return count;
+}
@@ -0,0 +1,56 @@
+#ifndef AVAILABILITY_H
+#define AVAILABILITY_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+// Slot-bitmap availability engine.
+// Library hours (8:00 AM - 8:00 PM) are cut into 5-minute slots: 144 slots fit in
+// three 64-bit words per room per day. A bit is set when any booking touches the slot,
+// so a partly used slot counts as busy. The bitmaps are therefore a prefilter: a free
+// answer is exact, and a busy one is confirmed against the interval index in db.c
+// unless the range lies on slot boundaries.
+//
+// Bitmaps are stored word-major (every room's word 0, then every room's word 1, ...)
+// so a query applies the same mask to all rooms in one flat loop that the compiler
+// vectorizes.
+
+#define SLOT_MINUTES 5
+#define LIBRARY_OPEN_MINUTES (8 * 60)
+#define LIBRARY_CLOSE_MINUTES (20 * 60)
+#define SLOTS_PER_DAY ((LIBRARY_CLOSE_MINUTES - LIBRARY_OPEN_MINUTES) / SLOT_MINUTES)
+#define SLOT_WORDS 3
+
+typedef struct {
+    uint64_t words[SLOT_WORDS];
+} SlotMask;
+
+typedef struct {
+    int day;        // day number, -1 when the entry is empty
+    int room_count;
+    uint64_t* busy; // busy[word * room_count + room]
+} DayAvailability;
+
+#define AVAILABILITY_CACHE_DAYS 64
+
+// Direct-mapped cache of day bitmaps (day % AVAILABILITY_CACHE_DAYS)
+typedef struct {
+    DayAvailability days[AVAILABILITY_CACHE_DAYS];
+} AvailabilityCache;
+
+//Function Declarations
+void slot_mask_for_range(int start_min, int end_min, SlotMask* mask);
+
+int day_availability_init(DayAvailability* avail, int day, int room_count);
+void day_availability_free(DayAvailability* avail);
+void day_availability_mark(DayAvailability* avail, int room, int start_min, int end_min);
+int availability_range_free(const DayAvailability* avail, int room, int start_min, int end_min);
+int availability_free_rooms(const DayAvailability* avail, int start_min, int end_min, int* rooms_out);
+
+void availability_cache_init(AvailabilityCache* cache);
+void availability_cache_free(AvailabilityCache* cache);
+DayAvailability* availability_cache_find(AvailabilityCache* cache, int day);
+DayAvailability* availability_cache_slot(AvailabilityCache* cache, int day, int room_count);
+void availability_cache_drop(AvailabilityCache* cache, int day);
+
+#endif // AVAILABILITY_H
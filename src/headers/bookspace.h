@@ -0,0 +1,203 @@
+#ifndef BOOKSPACE_H
+#define BOOKSPACE_H
+
+#include "reservation.h"
+#include "sqlite3.h"
+#include <stddef.h>
+
+// libbookspace: the reservation engine without any terminal I/O.
+// Every call takes an opaque Bookspace context from bookspace_open() and reports
+// its outcome as a BookspaceResult; nothing is printed except SQLite errors on stderr.
+// A context owns one SQLite connection and must only be used by one thread at a time.
+
+typedef struct Bookspace Bookspace;
+
+typedef enum {
+    BOOKSPACE_OK = 0,
+    BOOKSPACE_NOT_FOUND,            // no reservation with that ID
+    BOOKSPACE_CONFLICT,             // the room is already booked for part of the slot
+    BOOKSPACE_DUPLICATE_ID,         // the reservation ID is already taken
+    BOOKSPACE_INVALID_NAME,
+    BOOKSPACE_INVALID_STUDENT_NUM,
+    BOOKSPACE_INVALID_DATE,
+    BOOKSPACE_PAST_DATE,
+    BOOKSPACE_INVALID_TIME,
+    BOOKSPACE_OUTSIDE_HOURS,        // not within the room's open hours (at most 8:00 AM - 8:00 PM)
+    BOOKSPACE_BAD_RANGE,            // end time is not after start time
+    BOOKSPACE_UNKNOWN_ROOM,
+    BOOKSPACE_INVALID_ROOM,         // room name empty or too long, or capacity below 1
+    BOOKSPACE_DUPLICATE_ROOM,       // a room with that name already exists
+    BOOKSPACE_INVALID_ID,           // caller-supplied reservation ID is too long
+    BOOKSPACE_BUSY,                 // another connection held the write lock past the retry limit
+    BOOKSPACE_ERROR                 // SQLite or allocation failure
+} BookspaceResult;
+
+const char* bookspace_result_message(BookspaceResult result); // sentence for people
+const char* bookspace_result_name(BookspaceResult result);    // stable identifier, e.g. "conflict"
+
+//Pragma profile applied by bookspace_open()
+typedef struct {
+    const char* path;
+    const char* journal_mode;        // "WAL", "DELETE", ...
+    const char* synchronous;         // "NORMAL", "FULL", ...
+    int busy_timeout_ms;
+    int cache_size_kib;
+    long long mmap_size;             // bytes, 0 disables memory mapping
+    int temp_store_memory;           // 1 = temp_store=MEMORY
+    int wal_autocheckpoint_pages;    // SQLite's automatic checkpoint threshold
+    int checkpoint_every_commits;    // extra PASSIVE checkpoint after this many commits, 0 = off
+    int wal_truncate_pages;          // force a TRUNCATE checkpoint once the WAL exceeds this
+    long long journal_size_limit;    // bytes kept on disk after a checkpoint
+    int read_only;                   // 1 = query-only connection: no schema setup, checkpoints or writes
+    int profile;                     // 1 = record statement and operation timings (bookspace_stats_write)
+    long slow_query_us;              // statements at least this slow go to the slow-query log
+    int serialized;                  // 1 = SQLite's per-connection mutex (sharing a context across threads)
+} DatabaseConfig;
+
+void database_config_defaults(DatabaseConfig* config);
+
+// A booking as entered by a user: MM/DD/YYYY date, times in any format time_to_minutes() accepts
+typedef struct {
+    const char* name;
+    const char* student_num;         // 8 digits, '-', letter
+    const char* date;
+    const char* start_time;
+    const char* end_time;
+    const char* consultation_room;   // a room name from the catalog
+    const char* reservation_id;      // NULL or "" = generate one
+} BookingRequest;
+
+// Open/close (config NULL = database_config_defaults)
+BookspaceResult bookspace_open(const DatabaseConfig* config, Bookspace** out);
+void bookspace_close(Bookspace* bs);
+int checkpoint_database(Bookspace* bs, int truncate);
+
+// Room catalog, loaded into a compact array when the context opens. Rooms are addressed by
+// index (0 .. bookspace_room_count() - 1, in id order) in the availability calls. New rooms
+// get higher ids, so they are appended and existing indexes stay put.
+typedef struct {
+    int id;                          // rooms.id, what reservations reference
+    int capacity;                    // seats
+    int open_min;                    // bookable hours, minutes since midnight, within library hours
+    int close_min;
+    char name[MAX_ROOM_LENGTH];
+} Room;
+
+int bookspace_room_count(Bookspace* bs);
+const Room* bookspace_room(Bookspace* bs, int index);           // NULL if out of range
+int bookspace_find_room(Bookspace* bs, const char* name);        // index, -1 if unknown
+// New room; open/close NULL = library hours. *index_out (optional) gets its index.
+BookspaceResult bookspace_add_room(Bookspace* bs, const char* name, int capacity, const char* open_time,
+                                   const char* close_time, int* index_out);
+
+// Writes. Requests are fully validated before the database is touched.
+BookspaceResult bookspace_validate(Bookspace* bs, const BookingRequest* request);
+BookspaceResult bookspace_book(Bookspace* bs, const BookingRequest* request, char* id_out, size_t id_size);
+BookspaceResult bookspace_cancel(Bookspace* bs, const char* reservation_id);
+BookspaceResult bookspace_edit(Bookspace* bs, const char* reservation_id, const BookingRequest* request);
+
+// Group commit: every write between begin and commit shares one transaction (and one fsync).
+// Each write still gets its own result; if the commit fails, all of them are rolled back.
+BookspaceResult bookspace_begin_group(Bookspace* bs);
+BookspaceResult bookspace_commit_group(Bookspace* bs);
+
+// Profiling dump (contexts opened with config.profile): JSON, or Prometheus text exposition
+typedef enum {
+    STATS_FORMAT_JSON,
+    STATS_FORMAT_PROMETHEUS
+} StatsFormat;
+BookspaceResult bookspace_stats_write(FILE* out, StatsFormat format);
+
+// Point lookup, copied into *out
+BookspaceResult bookspace_get(Bookspace* bs, const char* reservation_id, Reservation* out);
+
+//Streaming reads. A row view is valid until the next step or close of its cursor
+typedef struct {
+    int id;
+    int day;          // days since 01/01/1970
+    int start_min;    // minutes since midnight
+    int end_min;
+    const char* name;
+    const char* student_num;
+    const char* reservation_id;
+    int room;                        // catalog index, -1 if the room is missing from the catalog
+    const char* consultation_room;   // the room's name
+    const char* created_at;
+} ReservationRow;
+
+typedef struct {
+    Bookspace* bs;
+    sqlite3_stmt* stmt;
+    int done;
+    int op;               // profiled operation (stats.h), -1 = none
+    long long started_ns;
+} ReservationCursor;
+
+typedef int (*ReservationVisitor)(const ReservationRow* row, void* data); // non-zero stops the scan
+
+int reservation_cursor_by_day(Bookspace* bs, ReservationCursor* cursor, int day);
+int reservation_cursor_by_date(Bookspace* bs, ReservationCursor* cursor, const char* date);
+int reservation_cursor_by_student_num(Bookspace* bs, ReservationCursor* cursor, const char* student_num);
+int reservation_cursor_by_id(Bookspace* bs, ReservationCursor* cursor, const char* reservation_id);
+int reservation_cursor_by_name(Bookspace* bs, ReservationCursor* cursor, const char* name);
+int reservation_cursor_all(Bookspace* bs, ReservationCursor* cursor);
+int reservation_cursor_next(ReservationCursor* cursor, ReservationRow* row);  // 1 row, 0 end, -1 error
+int reservation_cursor_read(ReservationCursor* cursor, Reservation* out);     // same, copied into *out
+void reservation_cursor_close(ReservationCursor* cursor);
+int for_each_reservation(ReservationCursor* cursor, ReservationVisitor visit, void* data); // closes the cursor
+
+// Availability, with user-entered date and times like BookingRequest
+// Sets *available to 1 if the room is free for the whole range, 0 if not
+BookspaceResult bookspace_room_available(Bookspace* bs, const char* date, const char* start_time, const char* end_time,
+                                         const char* consultation_room, int* available);
+// Indexes of the rooms open and free for the whole range; rooms_out needs room for
+// bookspace_room_count() entries, *count gets how many
+BookspaceResult bookspace_free_rooms(Bookspace* bs, const char* date, const char* start_time, const char* end_time,
+                                     int* rooms_out, int* count);
+// Earliest start at or after from_time with duration_min free minutes (room NULL = any room).
+// *start_min is -1 if the day has no such window; *room_out gets the room index.
+BookspaceResult bookspace_next_free(Bookspace* bs, const char* date, const char* from_time, int duration_min,
+                                    const char* consultation_room, int* start_min, int* room_out);
+
+// Free slot search: the first free gaps of at least duration_min minutes from date and
+// from_time (NULL = opening time) on, day by day for horizon_days days, in the room or, with
+// room NULL, in any room (earliest first, ties by room index). A gap is the whole free
+// stretch [start_min, end_min), inside the room's open hours.
+#define FREE_SLOT_MAX_HORIZON 366
+
+typedef struct {
+    int room;       // catalog index
+    int day;        // day number
+    int start_min;
+    int end_min;
+} FreeGap;
+
+// gaps_out holds max_gaps entries; *count gets how many were found (fewer = horizon reached)
+BookspaceResult bookspace_find_free_slots(Bookspace* bs, const char* date, const char* from_time, int duration_min,
+                                          const char* consultation_room, int horizon_days, FreeGap* gaps_out,
+                                          int max_gaps, int* count);
+
+// Free/busy grid over library hours for a run of days and a set of rooms. Each (day, room)
+// row holds cells_per_day characters, one per step_min minutes from 8:00 AM: GRID_FREE,
+// GRID_BUSY (a booking touches the cell, or the room closes during it) or GRID_CLOSED.
+#define GRID_FREE '.'
+#define GRID_BUSY '#'
+#define GRID_CLOSED 'x'
+#define GRID_MAX_DAYS 31
+
+typedef struct {
+    int first_day;      // day number of the first row block
+    int days;
+    int room_count;
+    int* rooms;         // catalog indexes, in row order
+    int step_min;       // cell width, a multiple of 5 minutes
+    int cells_per_day;
+    char* cells;        // row (day d, room r) starts at cells[(d * room_count + r) * cells_per_day]
+} AvailabilityGrid;
+
+// rooms NULL = every room in the catalog; free the grid with bookspace_grid_free()
+BookspaceResult bookspace_availability_grid(Bookspace* bs, const char* date, int days, const char* const* rooms,
+                                            int room_count, int step_min, AvailabilityGrid* grid);
+void bookspace_grid_free(AvailabilityGrid* grid);
+
+#endif // BOOKSPACE_H
@@ -0,0 +1,57 @@
+#ifndef CLI_H
+#define CLI_H
+
+#include "bookspace.h"
+#include <stdio.h>
+
+// Non-interactive command line, a second client of libbookspace next to the menu:
+//   LibraryReservation [--db PATH] [--format tsv|json|table] <command> [--flag value ...]
+//   LibraryReservation [--db PATH] [--format ...] --script <file|->
+// Commands: book, cancel, list, search, avail, stats (see README "Command Line").
+// A script runs one command per line through a single open database.
+
+//Exit status
+#define CLI_OK 0
+#define CLI_FAILED 1   // the library refused the operation (conflict, not found, ...)
+#define CLI_USAGE 2    // the command line itself is wrong
+
+#define CLI_MAX_ARGS 32
+#define CLI_MAX_LINE 1024
+
+// Accepted ranges of the numeric global flags
+#define CLI_MAX_GROUP 10000            // --group-max, writes per group commit
+#define CLI_MAX_GROUP_WAIT_US 1000000  // --group-wait-us
+#define CLI_MAX_READERS 256            // --readers (0 = serve reads on the event loop)
+#define CLI_MAX_SLOW_MS 3600000        // --slow-ms
+
+// Default files for "stats" (profiling counters, see --profile)
+#define CLI_STATS_PATH_JSON "data/bookspace-stats.json"
+#define CLI_STATS_PATH_PROMETHEUS "data/bookspace-stats.prom"
+
+// Output formats:
+//   tsv   one record per line, tab-separated, no header (default)
+//   json  one JSON object per line (JSON Lines)
+//   table the menu's bordered tables
+typedef enum {
+    FORMAT_TSV,
+    FORMAT_JSON,
+    FORMAT_TABLE
+} CliFormat;
+
+// A stream of commands against one open context (--script, the daemon's connections)
+typedef struct {
+    Bookspace* bs;
+    FILE* out;
+    FILE* err;
+    CliFormat format;  // default for commands without --format
+    long line_no;      // script line being run, 0 = no "line N:" prefix on errors
+    int protocol;      // 1 = every command ends with one status line (daemon protocol)
+    int replied;       // set once the current command wrote its status line
+} CliSession;
+
+void cli_session_init(CliSession* session, Bookspace* bs, FILE* out, FILE* err);
+int cli_command_writes(const char* line);          // 1 if the line is a write (book, cancel, addroom)
+int cli_execute(CliSession* session, char* line); // one command line, modified in place; returns CLI_*
+int cli_main(int argc, char* argv[]);
+
+#endif // CLI_H
@@ -1,29 +1,45 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include "bookspace.h"
 #include "sqlite3.h"
+#include "reservation.h"
 #include <stdio.h>
 #include <stdlib.h>
 
+// Storage layer behind libbookspace (bookspace.h): takes already validated slots in the
+// storage encoding (day number, minutes since midnight, room = catalog index) and does no
+// input checking.
+
 //DB Functions Declarations
-int initialize_database();
-int create_tables();
-int close_database();
-int check_time_conflict(const char* date, const char* start_time, const char* end_time, const char* consultation_room);
-int insert_reservation(const char* name, const char* student_num, const char* date, const char* start_time, const char* end_time, const char* reservation_id, const char* consultation_room);
-int delete_reservation(const char* reservation_id);
-int reservation_exists(const char* reservation_id);
-int get_reservations_by_date(const char* date);
-int get_reservations_by_student_num(const char* student_num);
-int get_reservations_by_id(const char* reservation_id);
-int get_all_reservations();
-int update_reservation(const char* reservation_id, const char* name, const char* date, const char* start_time, const char* end_time, const char* student_num, const char* consultation_room);
-int get_reservations_by_name(const char* name);
-
-
-//Callback functions
-int callback_print_reservations(void* data, int argc, char** argv, char** azColName);
-int callback_count_reservations(void* data, int argc, char** argv, char** azColName);
-
-
-#endif // DATABASE_H
\ No newline at end of file
+int initialize_database(const DatabaseConfig* config, Bookspace** out);
+int create_tables(Bookspace* bs);
+int close_database(Bookspace* bs);
+
+BookspaceResult insert_reservation_slot(Bookspace* bs, const char* name, const char* student_num, int day, int start_min, int end_min,
+                                        const char* reservation_id, int room);
+BookspaceResult update_reservation_slot(Bookspace* bs, const char* reservation_id, const char* name, const char* student_num,
+                                        int day, int start_min, int end_min, int room);
+BookspaceResult delete_reservation(Bookspace* bs, const char* reservation_id);
+int reservation_exists(Bookspace* bs, const char* reservation_id);
+int slot_available(Bookspace* bs, int day, int start_min, int end_min, int room); // 1 free, 0 booked, -1 error
+
+//Room catalog (index = position in the in-memory array, see bookspace_room())
+int room_count(Bookspace* bs);
+const Room* room_at(Bookspace* bs, int room);
+int find_room(Bookspace* bs, const char* name);
+BookspaceResult insert_room(Bookspace* bs, const char* name, int capacity, int open_min, int close_min, int* room_out);
+
+// Batched writes: one IMMEDIATE transaction around many insert_reservation_slot() calls
+int begin_batch(Bookspace* bs);
+int commit_batch(Bookspace* bs);
+void rollback_batch(Bookspace* bs);
+
+//Availability (room = catalog index, -1 = any room); only each room's open hours count as free
+int free_rooms(Bookspace* bs, int day, int start_min, int end_min, int* rooms_out);
+int first_free_window(Bookspace* bs, int day, int from_min, int duration_min, int room, int* room_out); // -1 none, -2 error
+int room_free_gaps(Bookspace* bs, int room, int first_day, int from_min, int last_day, int duration_min,
+                   FreeGap* out, int max_gaps); // count, -1 error
+int availability_grid_day(Bookspace* bs, int day, const int* rooms, int room_count, int step_min, char* cells); // 0 ok, 1 error
+
+#endif // DATABASE_H
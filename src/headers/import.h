@@ -0,0 +1,24 @@
+#ifndef IMPORT_H
+#define IMPORT_H
+
+#include "bookspace.h"
+#include <stdio.h>
+
+// Bulk import of reservations from CSV or TSV.
+// The first line is a header naming the columns (any order):
+//   student_name, student_num, date, start_time, end_time, consultation_room [, reservation_id]
+// Dates are MM/DD/YYYY and times use the same 12-hour formats as the menu (e.g. 10:30AM, 4PM).
+// Rows are committed in batches; a bad row is reported and skipped without failing its batch.
+
+#define IMPORT_DEFAULT_BATCH 10000
+#define IMPORT_MAX_LINE 1024
+
+typedef struct {
+    long rows;
+    long imported;
+    long rejected;
+} ImportStats;
+
+int import_reservations(Bookspace* bs, FILE* in, int batch_size, FILE* reject_log, ImportStats* stats);
+
+#endif // IMPORT_H
@@ -0,0 +1,44 @@
+#ifndef INTERVAL_INDEX_H
+#define INTERVAL_INDEX_H
+
+#include <stdlib.h>
+
+// In-process index of booked [start_min, end_min) intervals keyed by (room, day).
+// Each key holds a vector sorted by start time plus a running maximum of end times,
+// so an overlap check is one binary search even if stored intervals overlap.
+// A key that has never been loaded is "cold" and the database must be asked instead.
+
+typedef struct {
+    int start_min;
+    int end_min;
+} Interval;
+
+typedef struct {
+    int in_use;
+    int room;
+    int day;
+    int count;
+    int capacity;
+    Interval* intervals; // sorted by start_min
+    int* max_end;        // max_end[i] = largest end_min among intervals[0..i]
+} IntervalList;
+
+typedef struct {
+    IntervalList* slots; // open addressing, capacity is a power of two
+    int capacity;
+    int used;
+} IntervalIndex;
+
+#define INTERVAL_INDEX_MAX_KEYS 65536 // cache is dropped and reloaded lazily past this
+
+//Function Declarations
+void interval_index_init(IntervalIndex* index);
+void interval_index_free(IntervalIndex* index);
+void interval_index_clear(IntervalIndex* index);
+IntervalList* interval_index_find(IntervalIndex* index, int room, int day);
+IntervalList* interval_index_create(IntervalIndex* index, int room, int day);
+int interval_list_add(IntervalList* list, int start_min, int end_min);
+int interval_list_remove(IntervalList* list, int start_min, int end_min);
+int interval_list_overlaps(const IntervalList* list, int start_min, int end_min);
+
+#endif // INTERVAL_INDEX_H
@@ -12,9 +12,10 @@
 #define MAX_DATE_LENGTH 11
 #define MAX_TIME_LENGTH 10
 #define DB_PATH "data/library_reservations.db"
+#define RESERVATION_ID_SIZE 30 // MMDDYY-MMDDYY-NNNN-SSSSSSSSSS + terminator
 
 //Func Declarations
-int main();
+int main(int argc, char* argv[]);
 void main_menu();
 void view_daily_schedule();
 void make_reservation();
@@ -28,13 +29,17 @@ void pause_screen();
 // Utils
 void clear_input_buffer();
 void generate_reservation_id(char* out_id, size_t out_size, const char* reservation_date);
+void set_reservation_id_node(const char* node_name);
 int check_cancel_string(const char* input);
+int str_equals_ignore_case(const char* str1, const char* str2);
 int outside_time_bounds(const char* time);
 
 // Missing declarations
 int validate_date(const char* date);
 int validate_date_for_viewing(const char* date);
 int validate_time(const char* time);
+int normalize_time(char* time);
+int end_outside_time_bounds(const char* time);
 int validate_time_range(const char* start_time, const char* end_time);
 void format_time_24hour(char* time_12, char* time_24);
 #endif // MAIN_H
\ No newline at end of file
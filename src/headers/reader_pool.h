@@ -0,0 +1,33 @@
+#ifndef READER_POOL_H
+#define READER_POOL_H
+
+#include "bookspace.h"
+
+// Reader pool: worker threads that each own a read-only Bookspace (its own SQLite
+// connection, prepared statements and caches), so queries run in parallel under WAL
+// while a single writer keeps the read-write context.
+//
+// Jobs are spread round-robin over per-worker queues. A worker takes its newest job
+// first and, when its queue is empty, steals the oldest job from another worker, so a
+// few slow searches cannot leave the other cores idle.
+//
+// POSIX threads; elsewhere reader_pool_open() reports BOOKSPACE_ERROR.
+
+typedef struct ReaderPool ReaderPool;
+typedef struct ReaderJob ReaderJob;
+
+// Runs on a worker thread with that worker's read-only context. The job is not touched
+// by the pool after run() starts, so run() may hand it back to its owner or free it.
+typedef void (*ReaderJobFunc)(Bookspace* reader, ReaderJob* job);
+
+// Embed as the first member of the caller's job struct
+struct ReaderJob {
+    ReaderJobFunc run;
+};
+
+BookspaceResult reader_pool_open(const DatabaseConfig* config, int threads, ReaderPool** out);
+BookspaceResult reader_pool_submit(ReaderPool* pool, ReaderJob* job); // ERROR = not queued, run it yourself
+void reader_pool_close(ReaderPool* pool); // runs the queued jobs, then stops the workers
+int reader_pool_default_threads(void);   // online CPUs, at least 1
+
+#endif // READER_POOL_H
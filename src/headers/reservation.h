@@ -13,12 +13,7 @@
 #define MAX_TIME_LENGTH 10
 #define MAX_RESERVATION_ID_LENGTH 50
 #define MAX_STUD_ID_LENGTH 11
-#define MAX_ROOM_LENGTH 50
-#define NUM_ROOMS 4
-
-static const char* CONSULTATION_ROOMS[NUM_ROOMS] = {
-     "Room A", "Room B", "Room C", "Room D"
-};
+#define MAX_ROOM_LENGTH 50 // rooms themselves live in the catalog (bookspace_room())
 
 //Reservation Struct
 typedef struct {
@@ -34,12 +29,26 @@ typedef struct {
 
 //Function Declarations
 int validate_date(const char* date);
+int validate_student_name(const char* name);
+int validate_student_num(const char* student_num);
 int validate_time(const char* time);
+int normalize_time(char* time);
 int validate_time_range(const char* start_time, const char* end_time);
 int is_time_conflict(const char* start1, const char* end1, const char* start2, const char* end2);
 void format_time_12hour(char* time_24, char* time_12);
 void format_time_24hour(char* time_12, char* time_24);
 int compare_times(const char* time1, const char* time2);
+int outside_time_bounds(const char* time);
+int end_outside_time_bounds(const char* time);
 int validate_date_for_viewing(const char* date);
 
+// Storage encoding: day number (days since 01/01/1970) and minutes since midnight
+int date_to_day_number(const char* date);
+void day_number_to_date(int day_number, char* date);
+void split_day_number(int day_number, int* year, int* month, int* day);
+int today_day_number(); // local date, cached per process and refreshed at midnight
+int time_to_minutes(const char* time); // any accepted time format, -1 if invalid
+void minutes_to_time_24hour(int minutes, char* time_24);
+int minutes_to_time_12hour(int minutes, char* time_12);
+
  #endif // RESERVATION_H
\ No newline at end of file
@@ -0,0 +1,50 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "bookspace.h"
+#include <stdio.h>
+
+// Reservation daemon: one process owns the database, its prepared statements and caches,
+// and serves front-desk terminals over a local Unix domain socket.
+//
+// Protocol: requests are lines in the --script syntax (see cli.h), e.g.
+//   book --name "Ann Lee" --student 20231234-A --date 12/01/2026 --start 10AM --end 11AM --room "Room A"
+// Every non-blank request gets exactly one response, in request order:
+//   zero or more data lines (the CLI's tsv or json records), then one status line:
+//   "ok", "ok<TAB>id" or "error<TAB>name<TAB>message" (json: {"result":...} / {"error":...}).
+// Clients may pipeline: send many requests without waiting, then read the responses.
+//
+// Linux only (epoll); elsewhere server_run() and client_run() report an error.
+
+#define SERVER_DEFAULT_SOCKET "data/bookspace.sock"
+#define SERVER_MAX_EVENTS 64
+#define SERVER_READ_CHUNK 65536
+#define SERVER_MAX_OUTPUT (4 * 1024 * 1024) // stop reading requests while a client's replies pile up
+
+// Group commit: book/cancel requests from all clients are collected into one transaction
+// for up to SERVER_GROUP_COMMIT_WAIT_US or SERVER_GROUP_COMMIT_MAX writes, whichever comes
+// first, then committed with a single fsync. Each request is still checked against the
+// in-memory interval index in arrival order, and its reply is held until the commit.
+#define SERVER_GROUP_COMMIT_MAX 64
+#define SERVER_GROUP_COMMIT_WAIT_US 300
+
+// Reads (list, search, avail) run on a reader pool (reader_pool.h) of read-only connections,
+// one per thread, and only see committed data. The epoll thread stays the single writer.
+// A connection with writes in the open group reads on the writer, so it sees its own writes.
+
+typedef struct {
+    const char* socket_path;
+    int group_commit_max;       // writes per transaction, 1 = commit every write on its own
+    long group_commit_wait_us;  // longest a write waits for company before committing
+    int reader_threads;         // read-only connections for queries, -1 = one per CPU, 0 = none
+    DatabaseConfig database;
+} ServerConfig;
+
+void server_config_defaults(ServerConfig* config);
+int server_run(const ServerConfig* config); // returns when SIGINT/SIGTERM arrives
+
+// Stand-in client: sends every line of in (or the single request line) pipelined and
+// copies the responses to out. Returns CLI_FAILED if any response was an error.
+int client_run(const char* socket_path, FILE* in, const char* request, FILE* out);
+
+#endif // SERVER_H
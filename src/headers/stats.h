@@ -0,0 +1,40 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include "bookspace.h"
+#include <stdio.h>
+
+// Opt-in instrumentation (DatabaseConfig.profile): per-statement and per-operation call
+// counts, total time and latency histograms, plus a log of the latest slow statements.
+// The counters are process-wide and lock-free, so every context (the daemon's writer
+// and its reader threads alike) adds to the same totals. Dumped by bookspace_stats_write().
+
+// Histogram bucket b counts latencies below 2^b microseconds; the last one is +Inf
+#define STATS_BUCKETS 22
+#define STATS_MAX_STATEMENTS 32  // statement registry slots, the last one is "other"
+#define STATS_SLOW_LOG_SIZE 64   // slow statements kept, oldest overwritten first
+#define STATS_SQL_LENGTH 160
+
+typedef enum {
+    STATS_OP_BOOK,
+    STATS_OP_CANCEL,
+    STATS_OP_EDIT,
+    STATS_OP_SEARCH,  // by name, student number or ID, open to end of the cursor
+    STATS_OP_LIST,    // by date or everything, open to end of the cursor
+    STATS_OP_COUNT
+} StatsOp;
+
+void stats_enable(long slow_query_us); // turns recording on for the whole process
+int stats_enabled(void);
+long long stats_now_ns(void);
+
+// Operation timing: started = stats_start() (0 while disabled), then stats_finish()
+long long stats_start(void);
+void stats_finish(StatsOp op, long long started);
+
+// slot = statement registry index; name must be a static string, sql is copied if slow
+void stats_record_statement(int slot, const char* name, const char* sql, long long ns);
+
+int stats_write(FILE* out, StatsFormat format);
+
+#endif // STATS_H
@@ -0,0 +1,32 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "bookspace.h"
+#include <stdio.h>
+
+// Buffered renderer for the reservation tables.
+// Rows are formatted straight into one large buffer and handed to stdio in big writes,
+// so a full dump costs one fwrite per TABLE_BUFFER_SIZE bytes instead of one printf per row.
+// The layout matches the original printf format strings byte for byte.
+
+#define TABLE_BUFFER_SIZE 65536
+
+typedef struct {
+    FILE* out;
+    size_t len;
+    char buf[TABLE_BUFFER_SIZE];
+} TableRenderer;
+
+void table_init(TableRenderer* table, FILE* out);
+int table_flush(TableRenderer* table);
+
+void table_border(TableRenderer* table);     // +------+------+ ...
+void table_rule(TableRenderer* table);       // |------|------| ...
+void table_header(TableRenderer* table, const char* start_label, const char* end_label);
+void table_cells(TableRenderer* table, const char* reservation_id, const char* date, const char* room,
+                 const char* start_time, const char* end_time, const char* student_name);
+void table_message(TableRenderer* table, const char* message); // one cell spanning the table
+int table_row(const ReservationRow* row, void* table);          // ReservationVisitor
+int table_reservations(TableRenderer* table, ReservationCursor* cursor);
+
+#endif // TABLE_H
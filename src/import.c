@@ -0,0 +1,206 @@
+#include "headers/import.h"
+#include "headers/main.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+enum ImportColumn {
+    COL_NAME,
+    COL_STUDENT_NUM,
+    COL_DATE,
+    COL_START,
+    COL_END,
+    COL_ROOM,
+    COL_RESERVATION_ID,
+    COL_COUNT
+};
+
+static const char* COLUMN_NAMES[COL_COUNT] = {
+    "student_name", "student_num", "date", "start_time", "end_time", "consultation_room", "reservation_id"
+};
+
+#define IMPORT_MAX_FIELDS 16
+
+// Strip surrounding whitespace in place
+static char* trim(char* str) {
+    while (isspace((unsigned char)*str)) str++;
+    char* end = str + strlen(str);
+    while (end > str && isspace((unsigned char)end[-1])) end--;
+    *end = '\0';
+    return str;
+}
+
+// Split one line in place. Handles "quoted, fields" and "" escapes; returns the field count
+static int split_fields(char* line, char delimiter, char** fields, int max_fields) {
+    int count = 0;
+    char* read = line;
+
+    while (count < max_fields) {
+        char* write = read;
+        fields[count++] = read;
+
+        while (*read == ' ' || *read == '\t') {
+            if (*read == delimiter) break;
+            read++;
+        }
+        if (*read == '"') {
+            write = read;
+            fields[count - 1] = read++;
+            while (*read) {
+                if (*read == '"' && read[1] == '"') {
+                    *write++ = '"';
+                    read += 2;
+                } else if (*read == '"') {
+                    read++;
+                    break;
+                } else {
+                    *write++ = *read++;
+                }
+            }
+            while (*read && *read != delimiter) read++; // ignore junk after the closing quote
+        } else {
+            while (*read && *read != delimiter) read++;
+            write = read;
+        }
+
+        int last = *read != delimiter;
+        *write = '\0';
+        fields[count - 1] = trim(fields[count - 1]);
+        if (last) break;
+        read++;
+    }
+    return count;
+}
+
+static int is_blank(const char* line) {
+    while (*line) {
+        if (!isspace((unsigned char)*line)) return 0;
+        line++;
+    }
+    return 1;
+}
+
+static void reject(FILE* reject_log, ImportStats* stats, long line_no, const char* reason) {
+    stats->rejected++;
+    if (reject_log) {
+        fprintf(reject_log, "line %ld: %s\n", line_no, reason);
+    }
+}
+
+// Book one data row through the library, so it gets exactly the checks bookspace_book()
+// applies everywhere else; returns NULL on success or the reject reason
+static const char* import_row(Bookspace* bs, char** fields, int field_count, const int* column_at) {
+    const char* value[COL_COUNT];
+    for (int c = 0; c < COL_COUNT; c++) {
+        int at = column_at[c];
+        value[c] = (at >= 0 && at < field_count) ? fields[at] : "";
+    }
+
+    BookingRequest request = {
+        .name = value[COL_NAME],
+        .student_num = value[COL_STUDENT_NUM],
+        .date = value[COL_DATE],
+        .start_time = value[COL_START],
+        .end_time = value[COL_END],
+        .consultation_room = value[COL_ROOM],
+        .reservation_id = value[COL_RESERVATION_ID],
+    };
+    BookspaceResult result = bookspace_book(bs, &request, NULL, 0);
+    return result == BOOKSPACE_OK ? NULL : bookspace_result_message(result);
+}
+
+int import_reservations(Bookspace* bs, FILE* in, int batch_size, FILE* reject_log, ImportStats* stats) {
+    char line[IMPORT_MAX_LINE];
+    char* fields[IMPORT_MAX_FIELDS];
+    int column_at[COL_COUNT];
+    long line_no = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    if (batch_size <= 0) {
+        batch_size = IMPORT_DEFAULT_BATCH;
+    }
+
+    //HEADER ROW
+    do {
+        if (!fgets(line, sizeof(line), in)) {
+            fprintf(stderr, "Import error: missing header row.\n");
+            return 1;
+        }
+        line_no++;
+    } while (is_blank(line));
+
+    char delimiter = strchr(line, '\t') ? '\t' : ',';
+    line[strcspn(line, "\r\n")] = '\0';
+    int header_count = split_fields(line, delimiter, fields, IMPORT_MAX_FIELDS);
+
+    for (int c = 0; c < COL_COUNT; c++) {
+        column_at[c] = -1;
+        for (int i = 0; i < header_count; i++) {
+            if (str_equals_ignore_case(fields[i], COLUMN_NAMES[c])) {
+                column_at[c] = i;
+                break;
+            }
+        }
+        if (column_at[c] < 0 && c != COL_RESERVATION_ID) {
+            fprintf(stderr, "Import error: header is missing column '%s'.\n", COLUMN_NAMES[c]);
+            return 1;
+        }
+    }
+
+    //DATA ROWS, ONE GROUP COMMIT PER BATCH
+    int in_batch = 0;
+    long batch_imported = 0;
+    int status = 0;
+
+    while (fgets(line, sizeof(line), in)) {
+        line_no++;
+        size_t len = strcspn(line, "\r\n");
+        if (line[len] == '\0' && !feof(in)) {
+            // Longer than the buffer: drop the rest of the physical line
+            int c;
+            while ((c = fgetc(in)) != '\n' && c != EOF);
+            stats->rows++;
+            reject(reject_log, stats, line_no, "line too long");
+            continue;
+        }
+        line[len] = '\0';
+        if (is_blank(line)) continue;
+        stats->rows++;
+
+        if (in_batch == 0 && bookspace_begin_group(bs) != BOOKSPACE_OK) {
+            status = 1;
+            break;
+        }
+
+        int field_count = split_fields(line, delimiter, fields, IMPORT_MAX_FIELDS);
+        const char* reason = import_row(bs, fields, field_count, column_at);
+        if (reason) {
+            reject(reject_log, stats, line_no, reason);
+        } else {
+            batch_imported++;
+        }
+
+        if (++in_batch >= batch_size) {
+            if (bookspace_commit_group(bs) != BOOKSPACE_OK) {
+                status = 1;
+                break;
+            }
+            stats->imported += batch_imported;
+            batch_imported = 0;
+            in_batch = 0;
+        }
+    }
+
+    if (status == 0 && in_batch > 0) {
+        if (bookspace_commit_group(bs) != BOOKSPACE_OK) {
+            status = 1;
+        } else {
+            stats->imported += batch_imported;
+        }
+    }
+    if (status != 0) {
+        fprintf(stderr, "Import stopped at line %ld; rows since the last commit were rolled back.\n", line_no);
+    }
+    return status;
+}
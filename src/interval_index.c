@@ -0,0 +1,158 @@
+#include "headers/interval_index.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 64
+
+static unsigned int hash_key(int room, int day) {
+    // Mix room and day into one 32-bit value (Knuth multiplicative hash)
+    unsigned int h = (unsigned int)day * 2654435761u;
+    h ^= (unsigned int)room * 40503u + 0x9e3779b9u + (h << 6) + (h >> 2);
+    return h;
+}
+
+static void free_list(IntervalList* list) {
+    free(list->intervals);
+    free(list->max_end);
+    memset(list, 0, sizeof(*list));
+}
+
+void interval_index_init(IntervalIndex* index) {
+    index->slots = NULL;
+    index->capacity = 0;
+    index->used = 0;
+}
+
+void interval_index_clear(IntervalIndex* index) {
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->slots[i].in_use) {
+            free_list(&index->slots[i]);
+        }
+    }
+    index->used = 0;
+}
+
+void interval_index_free(IntervalIndex* index) {
+    interval_index_clear(index);
+    free(index->slots);
+    interval_index_init(index);
+}
+
+// Returns the slot holding (room, day), or the empty slot where it would go
+static IntervalList* probe(IntervalList* slots, int capacity, int room, int day) {
+    unsigned int mask = (unsigned int)capacity - 1;
+    unsigned int i = hash_key(room, day) & mask;
+
+    while (slots[i].in_use && (slots[i].room != room || slots[i].day != day)) {
+        i = (i + 1) & mask;
+    }
+    return &slots[i];
+}
+
+static int grow(IntervalIndex* index) {
+    int new_capacity = index->capacity ? index->capacity * 2 : INITIAL_CAPACITY;
+    IntervalList* new_slots = calloc((size_t)new_capacity, sizeof(IntervalList));
+    if (!new_slots) return 1;
+
+    for (int i = 0; i < index->capacity; i++) {
+        if (index->slots[i].in_use) {
+            *probe(new_slots, new_capacity, index->slots[i].room, index->slots[i].day) = index->slots[i];
+        }
+    }
+    free(index->slots);
+    index->slots = new_slots;
+    index->capacity = new_capacity;
+    return 0;
+}
+
+IntervalList* interval_index_find(IntervalIndex* index, int room, int day) {
+    if (index->capacity == 0) return NULL;
+
+    IntervalList* list = probe(index->slots, index->capacity, room, day);
+    return list->in_use ? list : NULL;
+}
+
+IntervalList* interval_index_create(IntervalIndex* index, int room, int day) {
+    IntervalList* list = interval_index_find(index, room, day);
+    if (list) {
+        list->count = 0; // reload: keep the buffers
+        return list;
+    }
+
+    if (index->used >= INTERVAL_INDEX_MAX_KEYS) {
+        interval_index_clear(index); // simplest bounded eviction: start cold again
+    }
+    // Keep the load factor under 70%
+    if ((index->used + 1) * 10 > index->capacity * 7 && grow(index) != 0) {
+        return NULL;
+    }
+
+    list = probe(index->slots, index->capacity, room, day);
+    list->in_use = 1;
+    list->room = room;
+    list->day = day;
+    index->used++;
+    return list;
+}
+
+static void rebuild_max_end(IntervalList* list, int from) {
+    for (int i = from; i < list->count; i++) {
+        int prev = i > 0 ? list->max_end[i - 1] : 0;
+        list->max_end[i] = list->intervals[i].end_min > prev ? list->intervals[i].end_min : prev;
+    }
+}
+
+// Number of intervals whose start_min is < value
+static int lower_bound_start(const IntervalList* list, int value) {
+    int lo = 0, hi = list->count;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (list->intervals[mid].start_min < value) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+int interval_list_add(IntervalList* list, int start_min, int end_min) {
+    if (list->count == list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 8;
+        Interval* intervals = realloc(list->intervals, (size_t)new_capacity * sizeof(Interval));
+        if (!intervals) return 1;
+        list->intervals = intervals;
+        int* max_end = realloc(list->max_end, (size_t)new_capacity * sizeof(int));
+        if (!max_end) return 1;
+        list->max_end = max_end;
+        list->capacity = new_capacity;
+    }
+
+    int pos = lower_bound_start(list, start_min);
+    memmove(&list->intervals[pos + 1], &list->intervals[pos], (size_t)(list->count - pos) * sizeof(Interval));
+    list->intervals[pos].start_min = start_min;
+    list->intervals[pos].end_min = end_min;
+    list->count++;
+    rebuild_max_end(list, pos);
+    return 0;
+}
+
+int interval_list_remove(IntervalList* list, int start_min, int end_min) {
+    for (int i = lower_bound_start(list, start_min); i < list->count && list->intervals[i].start_min == start_min; i++) {
+        if (list->intervals[i].end_min == end_min) {
+            memmove(&list->intervals[i], &list->intervals[i + 1], (size_t)(list->count - i - 1) * sizeof(Interval));
+            list->count--;
+            rebuild_max_end(list, i);
+            return 0;
+        }
+    }
+    return 1; // not found
+}
+
+int interval_list_overlaps(const IntervalList* list, int start_min, int end_min) {
+    // Only intervals starting before end_min can overlap; among those, one overlaps
+    // exactly when the largest end time is past start_min
+    int n = lower_bound_start(list, end_min);
+    return n > 0 && list->max_end[n - 1] > start_min;
+}
@@ -0,0 +1,245 @@
+#include "headers/reader_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+// Ring buffer of jobs. The owner pushes and pops at the back; thieves take from the front.
+typedef struct {
+    pthread_mutex_t lock;
+    ReaderJob** jobs;
+    size_t cap;
+    size_t head;
+    size_t count;
+} JobQueue;
+
+typedef struct {
+    ReaderPool* pool;
+    int index;
+    pthread_t thread;
+    Bookspace* bs;
+    JobQueue queue;
+} ReaderWorker;
+
+struct ReaderPool {
+    ReaderWorker* workers;
+    int count;
+    int started;
+    atomic_uint next_worker;   // round-robin target for jobs submitted from outside the pool
+
+    // Sleeping workers wait for queued > 0. queued is raised under idle_lock, so a
+    // submit cannot slip between a worker's check and its wait.
+    pthread_mutex_t idle_lock;
+    pthread_cond_t idle_cond;
+    atomic_size_t queued;
+    int stopping;
+};
+
+// Worker running on this thread, so jobs submitted by jobs stay on the submitting worker
+static _Thread_local ReaderWorker* current_worker = NULL;
+
+static int queue_push(JobQueue* queue, ReaderJob* job) {
+    int rc = 0;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count == queue->cap) {
+        size_t cap = queue->cap ? queue->cap * 2 : 64;
+        ReaderJob** jobs = malloc(cap * sizeof(*jobs));
+        if (!jobs) {
+            rc = 1;
+        } else {
+            for (size_t i = 0; i < queue->count; i++) {
+                jobs[i] = queue->jobs[(queue->head + i) % queue->cap];
+            }
+            free(queue->jobs);
+            queue->jobs = jobs;
+            queue->cap = cap;
+            queue->head = 0;
+        }
+    }
+    if (rc == 0) {
+        queue->jobs[(queue->head + queue->count) % queue->cap] = job;
+        queue->count++;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return rc;
+}
+
+// newest = 1: the owner's end (back), newest = 0: a thief's end (front)
+static ReaderJob* queue_take(JobQueue* queue, int newest) {
+    ReaderJob* job = NULL;
+    pthread_mutex_lock(&queue->lock);
+    if (queue->count > 0) {
+        if (newest) {
+            job = queue->jobs[(queue->head + queue->count - 1) % queue->cap];
+        } else {
+            job = queue->jobs[queue->head];
+            queue->head = (queue->head + 1) % queue->cap;
+        }
+        queue->count--;
+    }
+    pthread_mutex_unlock(&queue->lock);
+    return job;
+}
+
+static ReaderJob* take_job(ReaderWorker* self) {
+    ReaderPool* pool = self->pool;
+    ReaderJob* job = queue_take(&self->queue, 1);
+    for (int i = 1; !job && i < pool->count; i++) {
+        job = queue_take(&pool->workers[(self->index + i) % pool->count].queue, 0);
+    }
+    if (job) {
+        atomic_fetch_sub(&pool->queued, 1);
+    }
+    return job;
+}
+
+static void* worker_main(void* arg) {
+    ReaderWorker* self = arg;
+    ReaderPool* pool = self->pool;
+    current_worker = self;
+
+    for (;;) {
+        ReaderJob* job = take_job(self);
+        if (job) {
+            job->run(self->bs, job);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->idle_lock);
+        while (atomic_load(&pool->queued) == 0 && !pool->stopping) {
+            pthread_cond_wait(&pool->idle_cond, &pool->idle_lock);
+        }
+        int done = pool->stopping && atomic_load(&pool->queued) == 0;
+        pthread_mutex_unlock(&pool->idle_lock);
+        if (done) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+int reader_pool_default_threads(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (int)cpus : 1;
+}
+
+BookspaceResult reader_pool_open(const DatabaseConfig* config, int threads, ReaderPool** out) {
+    *out = NULL;
+    if (threads < 1) {
+        return BOOKSPACE_ERROR;
+    }
+    if (!sqlite3_threadsafe()) {
+        fprintf(stderr, "This SQLite is built with SQLITE_THREADSAFE=0; the reader pool needs 1 or 2.\n");
+        return BOOKSPACE_ERROR;
+    }
+    ReaderPool* pool = calloc(1, sizeof(*pool));
+    ReaderWorker* workers = calloc((size_t)threads, sizeof(*workers));
+    if (!pool || !workers) {
+        fprintf(stderr, "Out of memory creating the reader pool.\n");
+        free(pool);
+        free(workers);
+        return BOOKSPACE_ERROR;
+    }
+    pool->workers = workers;
+    pool->count = threads;
+    pthread_mutex_init(&pool->idle_lock, NULL);
+    pthread_cond_init(&pool->idle_cond, NULL);
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->next_worker, 0);
+
+    DatabaseConfig reader_config;
+    if (config) {
+        reader_config = *config;
+    } else {
+        database_config_defaults(&reader_config);
+    }
+    reader_config.read_only = 1;
+
+    // Open every connection before starting any thread, so a failure leaves nothing running
+    for (int i = 0; i < threads; i++) {
+        workers[i].pool = pool;
+        workers[i].index = i;
+        pthread_mutex_init(&workers[i].queue.lock, NULL);
+        if (bookspace_open(&reader_config, &workers[i].bs) != BOOKSPACE_OK) {
+            reader_pool_close(pool);
+            return BOOKSPACE_ERROR;
+        }
+    }
+    for (; pool->started < threads; pool->started++) {
+        if (pthread_create(&workers[pool->started].thread, NULL, worker_main, &workers[pool->started]) != 0) {
+            fprintf(stderr, "Failed to start reader thread %d.\n", pool->started);
+            reader_pool_close(pool);
+            return BOOKSPACE_ERROR;
+        }
+    }
+    *out = pool;
+    return BOOKSPACE_OK;
+}
+
+BookspaceResult reader_pool_submit(ReaderPool* pool, ReaderJob* job) {
+    ReaderWorker* target = current_worker;
+    if (!target || target->pool != pool) {
+        target = &pool->workers[atomic_fetch_add(&pool->next_worker, 1) % (unsigned)pool->count];
+    }
+    if (queue_push(&target->queue, job) != 0) {
+        return BOOKSPACE_ERROR;
+    }
+
+    pthread_mutex_lock(&pool->idle_lock);
+    atomic_fetch_add(&pool->queued, 1);
+    pthread_cond_signal(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+    return BOOKSPACE_OK;
+}
+
+void reader_pool_close(ReaderPool* pool) {
+    if (!pool) {
+        return;
+    }
+    pthread_mutex_lock(&pool->idle_lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->idle_cond);
+    pthread_mutex_unlock(&pool->idle_lock);
+
+    for (int i = 0; i < pool->started; i++) {
+        pthread_join(pool->workers[i].thread, NULL);
+    }
+    for (int i = 0; i < pool->count; i++) {
+        bookspace_close(pool->workers[i].bs);
+        pthread_mutex_destroy(&pool->workers[i].queue.lock);
+        free(pool->workers[i].queue.jobs);
+    }
+    pthread_cond_destroy(&pool->idle_cond);
+    pthread_mutex_destroy(&pool->idle_lock);
+    free(pool->workers);
+    free(pool);
+}
+
+#else
+
+int reader_pool_default_threads(void) {
+    return 1;
+}
+
+BookspaceResult reader_pool_open(const DatabaseConfig* config, int threads, ReaderPool** out) {
+    (void)config; (void)threads;
+    *out = NULL;
+    fprintf(stderr, "The reader pool needs POSIX threads.\n");
+    return BOOKSPACE_ERROR;
+}
+
+BookspaceResult reader_pool_submit(ReaderPool* pool, ReaderJob* job) {
+    (void)pool; (void)job;
+    return BOOKSPACE_ERROR;
+}
+
+void reader_pool_close(ReaderPool* pool) {
+    (void)pool;
+}
+
+#endif
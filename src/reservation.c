@@ -1,68 +1,40 @@
+#define _POSIX_C_SOURCE 200809L // localtime_r
 #include "headers/reservation.h"
+#include "headers/availability.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <ctype.h>
+#include <stdatomic.h>
 
 
-int validate_date(const char* date) {
-
-    // Check if date is in the past
-    time_t t = time(NULL); // gets current time and stores it in variable t
-    struct tm *today = localtime(&t); // Converts t to localtime as structure broken down to year month day
-    
-    // Extract the current year, month, and day numbers from today
-    int current_year = today->tm_year + 1900; // Counts years since 1900, e.g 1900 + 125 = 2025
-    int current_month = today->tm_mon + 1; // Months start at 0 (= January), and +1 is added so 1 = January
-    int current_day = today->tm_mday; // Gives the current day of the month (1-31)
-
-    // Expected format: MM/DD/YYYY
-    if (strlen(date) != 10) {
-        return 0; // Invalid length
-    }
-    
-    // Check format MM/DD/YYYY
-    if (date[2] != '/' || date[5] != '/') {
-        return 0; // Invalid separators
-    }
-    
-    // Check if all other characters are digits
-    for (int i = 0; i < 10; i++) {
-        if (i == 2 || i == 5) continue; // Skip separators
-        if (date[i] < '0' || date[i] > '9') {
-            return 0; // Invalid
-        }
+// Shared MM/DD/YYYY check for both validators: returns the day number if the date exists
+// and its year is between this year and five years ahead, otherwise -1
+static int bookable_day_number(const char* date) {
+    int day_number = date_to_day_number(date);
+    if (day_number < 0) {
+        return -1;
     }
-    
-    // Extract month, day, year
-    int month = (date[0] - '0') * 10 + (date[1] - '0');
-    int day = (date[3] - '0') * 10 + (date[4] - '0');
-    int year = (date[6] - '0') * 1000 + (date[7] - '0') * 100 + 
+
+    int year = (date[6] - '0') * 1000 + (date[7] - '0') * 100 +
                (date[8] - '0') * 10 + (date[9] - '0');
-    
-    // Basic validation
-    if (month < 1 || month > 12) return 0;
-    if (day < 1 || day > 31) return 0;
-    if (year < current_year || year > current_year + 5) return 0;
-    
-
-    // Check days in month
-    int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    
-    // Leap year check
-    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0))) {
-        days_in_month[1] = 29;
+    int current_year;
+    split_day_number(today_day_number(), &current_year, NULL, NULL);
+    if (year < current_year || year > current_year + 5) {
+        return -1;
     }
-    
-    if (day > days_in_month[month - 1]) return 0; // Invalid day for month
-
-    
-    // Check if user input date is earlier than today
-    if (year < current_year || // If year is smaller, it is in the past
-       (year == current_year && month < current_month) || // If month is smaller, it is in the past
-       (year == current_year && month == current_month && day < current_day)) { // If both year and month are smaller, it is in the past
-       printf("Error: A past date is invalid.\n"); // Invalid date because any of the three conditions are the past
+    return day_number;
+}
+
+int validate_date(const char* date) {
+    int day_number = bookable_day_number(date);
+    if (day_number < 0) {
+        return 0;
+    }
+
+    // Check if user input date is earlier than today (the caller reports it; no output here)
+    if (day_number < today_day_number()) {
         return 0; // Mark the date as invalid
     }
 
@@ -70,139 +42,48 @@ int validate_date(const char* date) {
 }
 
 int validate_date_for_viewing(const char* date){
+    return bookable_day_number(date) >= 0;
+}
 
-    // Check if date is in the past
-    time_t t = time(NULL); // gets current time and stores it in variable t
-    struct tm *today = localtime(&t); // Converts t to localtime as structure broken down to year month day
-    
-    // Extract the current year, month, and day numbers from today
-    int current_year = today->tm_year + 1900; // Counts years since 1900, e.g 1900 + 125 = 2025
-    int current_month = today->tm_mon + 1; // Months start at 0 (= January), and +1 is added so 1 = January
-    int current_day = today->tm_mday; // Gives the current day of the month (1-31)
-
-
-      // Expected format: MM/DD/YYYY
-    if (strlen(date) != 10) {
-        return 0; // Invalid length
+int validate_student_name(const char* name) {
+    // Letters and spaces only, must fit the name column
+    if (*name == '\0' || strlen(name) >= MAX_NAME_LENGTH) {
+        return 0;
     }
-    
-    // Check format MM/DD/YYYY
-    if (date[2] != '/' || date[5] != '/') {
-        return 0; // Invalid separators
-    }
-    
-    // Check if all other characters are digits
-    for (int i = 0; i < 10; i++) {
-        if (i == 2 || i == 5) continue; // Skip separators
-        if (date[i] < '0' || date[i] > '9') {
-            return 0; // Invalid
+    for (; *name; name++) {
+        if (!isalpha((unsigned char)*name) && *name != ' ') {
+            return 0;
         }
     }
-    
-    // Extract month, day, year
-    int month = (date[0] - '0') * 10 + (date[1] - '0');
-    int day = (date[3] - '0') * 10 + (date[4] - '0');
-    int year = (date[6] - '0') * 1000 + (date[7] - '0') * 100 + 
-               (date[8] - '0') * 10 + (date[9] - '0');
-    
-    // Basic validation
-    if (month < 1 || month > 12) return 0;
-    if (day < 1 || day > 31) return 0;
-    if (year < current_year || year > current_year + 5) return 0; // Reasonable year range
-    
-
-    // Check days in month
-    int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
-    
-    // Leap year check
-    if (month == 2 && ((year % 4 == 0 && year % 100 != 0) || (year % 400 == 0))) {
-        days_in_month[1] = 29;
-    }
-    
-    if (day > days_in_month[month - 1]) return 0; // Invalid day for month
+    return 1;
+}
 
-    return 1; // Valid date
+int validate_student_num(const char* student_num) {
+    // 8 digits, a dash and a letter, e.g. 20231234-A
+    return strlen(student_num) == 10 &&
+           strspn(student_num, "0123456789") == 8 &&
+           student_num[8] == '-' &&
+           isalpha((unsigned char)student_num[9]);
 }
 
 int validate_time(const char* time) {
-    int openTime = 8;  // 8:00 AM
-    int closeTime = 20; // 8:00 PM
-
-    // Expected format: HH:MM AM/PM
-    if (strlen(time) < 6 || strlen(time) > 8) {
-    // Short format [4pm, 6:30am, 11AM, 08:30PM etc]
-        if (strchr(time, ':') == NULL) {
-            int hour;
-            char meridian[3];
-                if (sscanf(time, "%d%2s", &hour, meridian) == 2) {
-                // Validate hour and AM/PM
-                    if (hour >= 1 && hour <= 12 && 
-                        (strcmp(meridian, "AM") == 0 || strcmp(meridian, "PM") == 0)) {    
-                        // Convert to full format [HH:00AM/HH:00PM]
-                        char formatted[10];
-                        sprintf(formatted, "%02d:00%s", hour, meridian);
-                        strcpy((char*)time, formatted);
-                        return 1;
-            }
-        }
-    }
-        return 0; // Invalid length
-    }
-    
-    // Check for AM/PM
-    char* ampm = strstr(time, "AM");
-    if (!ampm) ampm = strstr(time, "PM");
-    if (!ampm) return 0; // No AM/PM found
-    
-    // Check if AM/PM is at the end
-    if (strcmp(ampm, "AM") != 0 && strcmp(ampm, "PM") != 0) {
-        return 0; // AM/PM not at the end
-    }
-    
-    // Extract time part (before AM/PM)
-    int time_len = ampm - time;
-    if (time_len < 4 || time_len > 5) return 0; // Invalid time length
-    
-    // Check for colon
-    int colon_pos = -1;
-    for (int i = 0; i < time_len; i++) {
-        if (time[i] == ':') {
-            colon_pos = i;
-            break;
-        }
-    }
-    
-    if (colon_pos == -1 || colon_pos == 0 || colon_pos == time_len - 1) {
-        return 0; // No colon or colon in wrong position
-    }
-    
-    // Check hour part
-    for (int i = 0; i < colon_pos; i++) {
-        if (time[i] < '0' || time[i] > '9') return 0;
-    }
-    
-    // Check minute part
-    for (int i = colon_pos + 1; i < time_len; i++) {
-        if (time[i] < '0' || time[i] > '9') return 0;
+    // Accepts HH:MM AM/PM, short forms like 4PM, or 24-hour HH:MM
+    return time_to_minutes(time) >= 0;
+}
+
+int normalize_time(char* time) {
+    // Validates and rewrites the input in display form ("4PM" -> "4:00 PM"); returns minutes or -1
+    int minutes = time_to_minutes(time);
+    if (minutes >= 0) {
+        minutes_to_time_12hour(minutes, time);
     }
-    
-    // Extract and validate hour and minute
-    int hour = 0, minute = 0;
-    sscanf(time, "%d:%d", &hour, &minute);
-    
-    if (hour < 1 || hour > 12) return 0;
-    if (minute < 0 || minute > 59) return 0;
-    
-    return 1; // Valid time
+    return minutes;
 }
 
 int validate_time_range(const char* start_time, const char* end_time) {
-    char start_24[MAX_TIME_LENGTH], end_24[MAX_TIME_LENGTH];
-    
-    format_time_24hour((char*)start_time, start_24);
-    format_time_24hour((char*)end_time, end_24);
-    
-    return compare_times(start_24, end_24) < 0;
+    int start_min = time_to_minutes(start_time);
+    int end_min = time_to_minutes(end_time);
+    return start_min >= 0 && end_min > start_min;
 }
 
 int is_time_conflict(const char* start1, const char* end1, const char* start2, const char* end2) {
@@ -212,69 +93,226 @@ int is_time_conflict(const char* start1, const char* end1, const char* start2, c
 
 void format_time_12hour(char* time_24, char* time_12) {
     // Convert 24-hour format (HH:MM) to 12-hour format (HH:MM AM/PM)
-     int hour, minute;
-    sscanf(time_24, "%d:%d", &hour, &minute);
-    
-    int hour_12 = hour;
-    char* period = "AM";
-    
-    if (hour == 0) {
-        hour_12 = 12;
-    } else if (hour == 12) {
-        period = "PM";
-    } else if (hour > 12) {
-        hour_12 = hour - 12;
-        period = "PM";
+    int minutes = time_to_minutes(time_24);
+    if (minutes < 0) {
+        time_12[0] = '\0'; // Invalid input
+        return;
     }
-    
-    sprintf(time_12, "%d:%02d %s", hour_12, minute, period);
+    minutes_to_time_12hour(minutes, time_12);
 }
 
 void format_time_24hour(char* time_12, char* time_24) {
     // Convert 12-hour format (HH:MM AM/PM) to 24-hour format (HH:MM)
+    int minutes = time_to_minutes(time_12);
+    if (minutes < 0) {
+        time_24[0] = '\0'; // Invalid input
+        return;
+    }
+    minutes_to_time_24hour(minutes, time_24);
+}
+
+int compare_times(const char* time1, const char* time2) {
+    // Negative, zero or positive like strcmp; any accepted format on either side
+    return time_to_minutes(time1) - time_to_minutes(time2);
+}
+
+int outside_time_bounds(const char* time) {
+    // Check if a start time is outside library hours (8:00 AM to 8:00 PM)
+    int minutes = time_to_minutes(time);
+    if (minutes < LIBRARY_OPEN_MINUTES || minutes >= LIBRARY_CLOSE_MINUTES) {
+        return 1; // Outside bounds
+    }
+    return 0; // Within bounds
+}
+
+int end_outside_time_bounds(const char* time) {
+    // An end time may be exactly closing time
+    int minutes = time_to_minutes(time);
+    if (minutes <= LIBRARY_OPEN_MINUTES || minutes > LIBRARY_CLOSE_MINUTES) {
+        return 1;
+    }
+    return 0;
+}
 
-    if (!validate_time(time_12)) {
-    time_24[0] = '\0'; // Invalid input
-    return;
+// Integer date/time encoding used for storage
+// day number = days since 01/01/1970, time = minutes since midnight
+
+static int is_leap_year(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || (year % 400 == 0);
 }
 
+static int days_from_civil(int year, int month, int day) {
+    // Proleptic Gregorian calendar, valid for any year
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yoe = year - era * 400;
+    int doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
 
-    int hour, minute;
-    char period[3];
-    sscanf(time_12, "%d:%d %2s", &hour, &minute, period);
-    
-    if (strcmp(period, "PM") == 0 && hour != 12) {
-        hour += 12;
-    } else if (strcmp(period, "AM") == 0 && hour == 12) {
-        hour = 0;
+int date_to_day_number(const char* date) {
+    // Expected format: MM/DD/YYYY, returns -1 if malformed
+    if (strlen(date) != 10 || date[2] != '/' || date[5] != '/') {
+        return -1;
+    }
+    for (int i = 0; i < 10; i++) {
+        if (i == 2 || i == 5) continue;
+        if (date[i] < '0' || date[i] > '9') return -1;
     }
-    
-    sprintf(time_24, "%02d:%02d", hour, minute);
+
+    int month = (date[0] - '0') * 10 + (date[1] - '0');
+    int day = (date[3] - '0') * 10 + (date[4] - '0');
+    int year = (date[6] - '0') * 1000 + (date[7] - '0') * 100 +
+               (date[8] - '0') * 10 + (date[9] - '0');
+
+    int days_in_month[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (is_leap_year(year)) days_in_month[1] = 29;
+
+    if (month < 1 || month > 12) return -1;
+    if (day < 1 || day > days_in_month[month - 1]) return -1;
+
+    return days_from_civil(year, month, day);
 }
 
-int compare_times(const char* time1, const char* time2) {
-    // Compare two times in HH:MM format
-    int hour1, minute1, hour2, minute2;
-    sscanf(time1, "%d:%d", &hour1, &minute1);
-    sscanf(time2, "%d:%d", &hour2, &minute2);
-    
-    if (hour1 != hour2) {
-        return hour1 - hour2;
+void split_day_number(int day_number, int* year_out, int* month_out, int* day_out) {
+    // Inverse of days_from_civil; any output pointer may be NULL
+    int z = day_number + 719468;
+    int era = (z >= 0 ? z : z - 146096) / 146097;
+    int doe = z - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    int day = doy - (153 * mp + 2) / 5 + 1;
+    int month = mp + (mp < 10 ? 3 : -9);
+    int year = yoe + era * 400 + (month <= 2);
+
+    if (year_out) *year_out = year;
+    if (month_out) *month_out = month;
+    if (day_out) *day_out = day;
+}
+
+// Today's day number and the local midnight that ends it, packed into one word
+// (midnight << TODAY_DAY_BITS | day) so threads always see a matching pair.
+#define TODAY_DAY_BITS 24
+static _Atomic long long today_cache = 0;
+
+static long long load_today() {
+    time_t now = time(NULL);
+    struct tm local;
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    long long day_number = days_from_civil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday);
+
+    local.tm_mday += 1;
+    local.tm_hour = 0;
+    local.tm_min = 0;
+    local.tm_sec = 0;
+    local.tm_isdst = -1;
+    time_t next_midnight = mktime(&local);
+    // mktime can fail (-1); recheck in a day rather than shift a negative value
+    long long midnight = next_midnight == (time_t)-1 ? (long long)now + 86400 : (long long)next_midnight;
+
+    long long packed = (midnight << TODAY_DAY_BITS) | day_number;
+    atomic_store_explicit(&today_cache, packed, memory_order_relaxed);
+    return packed;
+}
+
+int today_day_number() {
+    long long packed = atomic_load_explicit(&today_cache, memory_order_relaxed);
+    if ((long long)time(NULL) >= (packed >> TODAY_DAY_BITS)) {
+        packed = load_today(); // first call, or the day rolled over
     }
-    return minute1 - minute2;
+    return (int)(packed & ((1LL << TODAY_DAY_BITS) - 1));
 }
 
-int outside_time_bounds(const char* time) {
-    // Check if time is outside library hours (8:00 AM to 8:00 PM)
-    char time_24[MAX_TIME_LENGTH];
-    format_time_24hour((char*)time, time_24);
-    
-    int hour, minute;
-    sscanf(time_24, "%d:%d", &hour, &minute);
-    
-    if (hour < 8 || (hour >= 20)) {
-        printf("Error: Time must be between 8:00 AM and 8:00 PM.\n");
-        return 1; // Outside bounds
+void day_number_to_date(int day_number, char* date) {
+    // Writes MM/DD/YYYY
+    int year, month, day;
+    split_day_number(day_number, &year, &month, &day);
+
+    // Written digit by digit; this runs once per printed row
+    date[0] = (char)('0' + month / 10);
+    date[1] = (char)('0' + month % 10);
+    date[2] = '/';
+    date[3] = (char)('0' + day / 10);
+    date[4] = (char)('0' + day % 10);
+    date[5] = '/';
+    date[6] = (char)('0' + year / 1000 % 10);
+    date[7] = (char)('0' + year / 100 % 10);
+    date[8] = (char)('0' + year / 10 % 10);
+    date[9] = (char)('0' + year % 10);
+    date[10] = '\0';
+}
+
+int time_to_minutes(const char* time) {
+    // Single pass over "h:mmAM", "hh:mm PM", "hAM" or 24-hour "HH:MM" (meridian in either case).
+    // Returns minutes since midnight, or -1 if the text is not a valid time.
+    const unsigned char* p = (const unsigned char*)time;
+    unsigned hour, minute = 0, digit;
+    int has_minutes = 0;
+
+    if ((digit = p[0] - '0') > 9) return -1;
+    hour = digit;
+    p++;
+    if ((digit = p[0] - '0') <= 9) {
+        hour = hour * 10 + digit;
+        p++;
     }
-    return 0; // Within bounds
+
+    if (p[0] == ':') {
+        // Check each digit before reading the next: "9:" ends right after the colon
+        unsigned tens, ones;
+        if ((tens = p[1] - '0') > 5) return -1;
+        if ((ones = p[2] - '0') > 9) return -1;
+        minute = tens * 10 + ones;
+        has_minutes = 1;
+        p += 3;
+    }
+
+    if (p[0] == ' ') p++;
+    unsigned meridian = p[0] | 0x20; // ASCII lower case
+    if (meridian == 'a' || meridian == 'p') {
+        if ((p[1] | 0x20) != 'm' || p[2] != '\0') return -1;
+        if (hour < 1 || hour > 12) return -1;
+        hour = hour % 12 + (meridian == 'p' ? 12 : 0);
+        return (int)(hour * 60 + minute);
+    }
+
+    // No meridian: 24-hour clock, minutes required
+    if (p[0] != '\0' || !has_minutes || hour > 23) return -1;
+    return (int)(hour * 60 + minute);
+}
+
+void minutes_to_time_24hour(int minutes, char* time_24) {
+    int hour = minutes / 60, minute = minutes % 60;
+    time_24[0] = (char)('0' + hour / 10);
+    time_24[1] = (char)('0' + hour % 10);
+    time_24[2] = ':';
+    time_24[3] = (char)('0' + minute / 10);
+    time_24[4] = (char)('0' + minute % 10);
+    time_24[5] = '\0';
+}
+
+int minutes_to_time_12hour(int minutes, char* time_12) {
+    // Same text as format_time_12hour ("9:05 AM", "12:30 PM") without sscanf/sprintf; returns the length
+    int hour = minutes / 60, minute = minutes % 60;
+    int hour_12 = hour % 12 == 0 ? 12 : hour % 12;
+    int len = 0;
+
+    if (hour_12 >= 10) {
+        time_12[len++] = '1';
+    }
+    time_12[len++] = (char)('0' + hour_12 % 10);
+    time_12[len++] = ':';
+    time_12[len++] = (char)('0' + minute / 10);
+    time_12[len++] = (char)('0' + minute % 10);
+    time_12[len++] = ' ';
+    time_12[len++] = hour < 12 ? 'A' : 'P';
+    time_12[len++] = 'M';
+    time_12[len] = '\0';
+    return len;
 }
@@ -0,0 +1,749 @@
+#define _GNU_SOURCE // fopencookie, accept4
+#include "headers/server.h"
+#include "headers/cli.h"
+#include "headers/bookspace.h"
+#include "headers/reader_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void server_config_defaults(ServerConfig* config) {
+    config->socket_path = SERVER_DEFAULT_SOCKET;
+    config->group_commit_max = SERVER_GROUP_COMMIT_MAX;
+    config->group_commit_wait_us = SERVER_GROUP_COMMIT_WAIT_US;
+    config->reader_threads = -1;
+    database_config_defaults(&config->database);
+}
+
+#ifdef __linux__
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} ByteBuffer;
+
+typedef struct ServerRead ServerRead;
+
+// One client. Responses are written through a stdio stream that appends to out,
+// so the CLI's formatters are reused unchanged.
+typedef struct {
+    int fd;
+    ByteBuffer in;
+    ByteBuffer out;
+    size_t out_sent;
+    FILE* stream;
+    CliSession session;
+    int discarding;   // dropping the rest of an over-long request line
+    int peer_closed;  // no more requests; close once the replies are sent
+    int want_write;   // EPOLLOUT wanted
+    unsigned events;  // epoll events registered
+
+    // Read request running on the reader pool. Nothing else of this connection runs
+    // until it is back, which keeps the replies in request order.
+    ServerRead* reading;
+    int closed;       // socket already closed; freed when the read comes back
+
+    // Group commit: replies from group_mark on are held until the group commits,
+    // and the requests behind them are kept in replay (NUL-separated) in case it fails
+    int in_group;
+    size_t group_mark;
+    ByteBuffer replay;
+} Connection;
+
+typedef struct {
+    const ServerConfig* config;
+    Bookspace* bs;
+    int epoll_fd;
+    int timer_fd;
+
+    // Open write group: one transaction shared by every request run since it began
+    int group_open;
+    int group_writes;
+    Connection** group;
+    size_t group_count;
+    size_t group_cap;
+
+    // Reader pool (NULL = every request runs on this thread). Finished reads are queued
+    // on done and announced through done_fd.
+    ReaderPool* pool;
+    int done_fd;
+    pthread_mutex_t done_lock;
+    ServerRead* done;
+    ServerRead* done_tail;
+} Server;
+
+// A read request handed to the pool, with its reply rendered into a private stream
+struct ServerRead {
+    ReaderJob job;
+    Server* srv;
+    Connection* conn;
+    CliFormat format;
+    char line[CLI_MAX_LINE];
+    char* reply;
+    size_t reply_len;
+    ServerRead* next;
+};
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static int buffer_reserve(ByteBuffer* buf, size_t extra) {
+    if (buf->len + extra <= buf->cap) {
+        return 0;
+    }
+    size_t cap = buf->cap ? buf->cap : 4096;
+    while (cap < buf->len + extra) cap *= 2;
+    char* data = realloc(buf->data, cap);
+    if (!data) {
+        return 1;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return 0;
+}
+
+// fopencookie write hook: append to the connection's output buffer
+static ssize_t stream_write(void* cookie, const char* data, size_t size) {
+    Connection* conn = cookie;
+    if (buffer_reserve(&conn->out, size) != 0) {
+        return -1;
+    }
+    memcpy(conn->out.data + conn->out.len, data, size);
+    conn->out.len += size;
+    return (ssize_t)size;
+}
+
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    return flags < 0 ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static Connection* connection_open(int fd, Bookspace* bs) {
+    Connection* conn = calloc(1, sizeof(*conn));
+    if (!conn) {
+        return NULL;
+    }
+    cookie_io_functions_t io = { NULL, stream_write, NULL, NULL };
+    conn->stream = fopencookie(conn, "w", io);
+    if (!conn->stream) {
+        free(conn);
+        return NULL;
+    }
+    setvbuf(conn->stream, NULL, _IOFBF, SERVER_READ_CHUNK);
+    conn->fd = fd;
+    conn->events = EPOLLIN;
+    cli_session_init(&conn->session, bs, conn->stream, conn->stream);
+    conn->session.protocol = 1;
+    return conn;
+}
+
+static void connection_free(Connection* conn) {
+    fclose(conn->stream);
+    free(conn->in.data);
+    free(conn->out.data);
+    free(conn->replay.data);
+    free(conn);
+}
+
+static void connection_close(Server* srv, Connection* conn) {
+    if (conn->in_group) {
+        for (size_t i = 0; i < srv->group_count; i++) {
+            if (srv->group[i] == conn) {
+                srv->group[i] = srv->group[--srv->group_count];
+                break;
+            }
+        }
+    }
+    epoll_ctl(srv->epoll_fd, EPOLL_CTL_DEL, conn->fd, NULL);
+    close(conn->fd);
+    if (conn->reading) {
+        conn->closed = 1; // the pool still holds a request of this connection
+        return;
+    }
+    connection_free(conn);
+}
+
+// Requests are read unless one is out on the reader pool; EPOLLOUT while replies wait
+static void watch_connection(int epoll_fd, Connection* conn, int want_write) {
+    conn->want_write = want_write;
+    unsigned events = (conn->reading ? 0 : EPOLLIN) | (want_write ? EPOLLOUT : 0);
+    if (conn->events == events) {
+        return;
+    }
+    struct epoll_event ev = { .events = events, .data.ptr = conn };
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->events = events;
+}
+
+static void set_group_timer(Server* srv, long wait_us) {
+    struct itimerspec when;
+    memset(&when, 0, sizeof(when));
+    when.it_value.tv_sec = wait_us / 1000000;
+    when.it_value.tv_nsec = (wait_us % 1000000) * 1000;
+    timerfd_settime(srv->timer_fd, 0, &when, NULL); // all zero disarms
+}
+
+static void open_group(Server* srv) {
+    if (bookspace_begin_group(srv->bs) != BOOKSPACE_OK) {
+        return; // lock held elsewhere: this request commits on its own
+    }
+    srv->group_open = 1;
+    srv->group_writes = 0;
+    set_group_timer(srv, srv->config->group_commit_wait_us > 0 ? srv->config->group_commit_wait_us : 1);
+}
+
+static void join_group(Server* srv, Connection* conn, const char* line) {
+    if (!conn->in_group) {
+        if (srv->group_count == srv->group_cap) {
+            size_t cap = srv->group_cap ? srv->group_cap * 2 : 16;
+            Connection** group = realloc(srv->group, cap * sizeof(*group));
+            if (!group) {
+                return; // runs outside the group's bookkeeping; only its replay is lost
+            }
+            srv->group = group;
+            srv->group_cap = cap;
+        }
+        fflush(conn->stream);
+        conn->group_mark = conn->out.len;
+        conn->in_group = 1;
+        srv->group[srv->group_count++] = conn;
+    }
+    size_t len = strlen(line) + 1;
+    if (buffer_reserve(&conn->replay, len) == 0) {
+        memcpy(conn->replay.data + conn->replay.len, line, len);
+        conn->replay.len += len;
+    }
+}
+
+static int flush_output(int epoll_fd, Connection* conn);
+
+// Commits the open group and releases every held reply. If the commit fails the whole
+// group was rolled back, so each member's held requests are re-run one at a time and
+// every client still gets the result of its own request.
+static void commit_group(Server* srv) {
+    set_group_timer(srv, 0);
+    srv->group_open = 0;
+    int failed = bookspace_commit_group(srv->bs) != BOOKSPACE_OK;
+
+    size_t count = srv->group_count;
+    srv->group_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        Connection* conn = srv->group[i];
+        if (failed) {
+            fflush(conn->stream);
+            conn->out.len = conn->group_mark;
+            for (size_t at = 0; at < conn->replay.len; at += strlen(conn->replay.data + at) + 1) {
+                cli_execute(&conn->session, conn->replay.data + at);
+            }
+            fflush(conn->stream);
+        }
+        conn->in_group = 0;
+        conn->replay.len = 0;
+    }
+
+    // A failed send or a finished peer shows up again on the next epoll_wait, which closes it
+    for (size_t i = 0; i < count; i++) {
+        flush_output(srv->epoll_fd, srv->group[i]);
+    }
+}
+
+// Reader pool job: runs the request on the worker's read-only context
+static void run_read(Bookspace* reader, ReaderJob* job) {
+    ServerRead* read = (ServerRead*)job;
+    FILE* out = open_memstream(&read->reply, &read->reply_len);
+    if (out) {
+        CliSession session;
+        cli_session_init(&session, reader, out, out);
+        session.protocol = 1;
+        session.format = read->format;
+        cli_execute(&session, read->line);
+        fclose(out);
+    }
+
+    Server* srv = read->srv;
+    pthread_mutex_lock(&srv->done_lock);
+    if (srv->done_tail) {
+        srv->done_tail->next = read;
+    } else {
+        srv->done = read;
+    }
+    srv->done_tail = read;
+    pthread_mutex_unlock(&srv->done_lock);
+    eventfd_write(srv->done_fd, 1);
+}
+
+// Hands a read to the pool. Returns 0 if it was queued; the connection then waits for it.
+static int offload_read(Server* srv, Connection* conn, const char* line) {
+    size_t len = strlen(line);
+    ServerRead* read = calloc(1, sizeof(*read));
+    if (!read || len >= sizeof(read->line)) {
+        free(read);
+        return 1;
+    }
+    read->job.run = run_read;
+    read->srv = srv;
+    read->conn = conn;
+    read->format = conn->session.format;
+    memcpy(read->line, line, len + 1);
+
+    conn->reading = read;
+    if (reader_pool_submit(srv->pool, &read->job) != BOOKSPACE_OK) {
+        conn->reading = NULL;
+        free(read);
+        return 1;
+    }
+    return 0;
+}
+
+// Runs one request. Reads go to the reader pool, which only sees committed data, unless
+// the connection has writes in the open group. Writes open a group; while it is open every
+// request run here joins it, so no reply that depends on uncommitted data leaves before
+// the commit.
+static void run_request(Server* srv, Connection* conn, char* line) {
+    int writes = cli_command_writes(line);
+    if (!writes && srv->pool && !conn->in_group && line[strspn(line, " \t")] != '\0' &&
+        offload_read(srv, conn, line) == 0) {
+        return;
+    }
+    if (writes && !srv->group_open && srv->config->group_commit_max > 1) {
+        open_group(srv);
+    }
+    if (srv->group_open) {
+        join_group(srv, conn, line);
+    }
+
+    cli_execute(&conn->session, line);
+
+    if (writes && srv->group_open && ++srv->group_writes >= srv->config->group_commit_max) {
+        commit_group(srv);
+    }
+}
+
+// Executes every complete request line in the input buffer, in order.
+// Stops early while too many replies are waiting to be sent.
+static void process_requests(Server* srv, Connection* conn) {
+    size_t start = 0;
+    while (!conn->reading && conn->out.len - conn->out_sent < SERVER_MAX_OUTPUT) {
+        char* line = conn->in.data + start;
+        char* newline = memchr(line, '\n', conn->in.len - start);
+        if (!newline) {
+            break;
+        }
+        *newline = '\0';
+        start = (size_t)(newline - conn->in.data) + 1;
+
+        if (conn->discarding) {
+            conn->discarding = 0; // tail of an over-long line
+            continue;
+        }
+        if (newline > line && newline[-1] == '\r') newline[-1] = '\0';
+        run_request(srv, conn, line);
+    }
+
+    // Keep the unprocessed tail; a partial line longer than any request is answered now
+    memmove(conn->in.data, conn->in.data + start, conn->in.len - start);
+    conn->in.len -= start;
+    if (!conn->discarding && conn->in.len >= CLI_MAX_LINE && !memchr(conn->in.data, '\n', conn->in.len)) {
+        fputs("error\tusage\trequest line too long\n", conn->stream);
+        conn->in.len = 0;
+        conn->discarding = 1;
+    } else if (conn->discarding) {
+        conn->in.len = 0;
+    }
+    fflush(conn->stream);
+    watch_connection(srv->epoll_fd, conn, conn->want_write);
+}
+
+// Sends as much pending output as the socket takes. Returns -1 if the peer is gone.
+static int flush_output(int epoll_fd, Connection* conn) {
+    while (conn->out_sent < conn->out.len) {
+        ssize_t n = send(conn->fd, conn->out.data + conn->out_sent, conn->out.len - conn->out_sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                watch_connection(epoll_fd, conn, 1);
+                return 0;
+            }
+            return -1;
+        }
+        conn->out_sent += (size_t)n;
+    }
+    conn->out.len = conn->out_sent = 0;
+    watch_connection(epoll_fd, conn, 0);
+    return 0;
+}
+
+// Returns -1 when the connection should be closed
+static int handle_readable(Server* srv, Connection* conn) {
+    for (;;) {
+        if (buffer_reserve(&conn->in, SERVER_READ_CHUNK) != 0) {
+            return -1;
+        }
+        ssize_t n = recv(conn->fd, conn->in.data + conn->in.len, SERVER_READ_CHUNK, 0);
+        if (n > 0) {
+            conn->in.len += (size_t)n;
+            process_requests(srv, conn);
+            if (conn->reading || conn->out.len - conn->out_sent >= SERVER_MAX_OUTPUT) {
+                return 0; // resume once the read is back or the replies drain
+            }
+            continue;
+        }
+        if (n == 0) {
+            // A final request without a newline still counts
+            if (conn->in.len > 0 && buffer_reserve(&conn->in, 1) == 0) {
+                conn->in.data[conn->in.len++] = '\n';
+                process_requests(srv, conn);
+            }
+            conn->peer_closed = 1;
+            return 0;
+        }
+        if (errno == EINTR) continue;
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+    }
+}
+
+static int open_listener(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    unlink(path); // stale socket from a previous run
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        fprintf(stderr, "Cannot listen on %s: %s\n", path, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends what a connection has ready, runs requests held back by a full output buffer,
+// and closes it once it failed or the peer is done and every reply is out
+static void service_connection(Server* srv, Connection* conn, int failed) {
+    // Replies of a connection in the open group wait for commit_group()
+    if (!failed && !conn->in_group && conn->out.len > conn->out_sent) {
+        failed = flush_output(srv->epoll_fd, conn) != 0;
+        // Drained below the limit: run the requests that were held back
+        if (!failed && conn->in.len > 0 && !conn->reading && conn->out.len - conn->out_sent < SERVER_MAX_OUTPUT) {
+            process_requests(srv, conn);
+            if (!conn->in_group) {
+                failed = flush_output(srv->epoll_fd, conn) != 0;
+            }
+        }
+    }
+    if (failed || (conn->peer_closed && !conn->in_group && !conn->reading && conn->out.len == conn->out_sent)) {
+        connection_close(srv, conn);
+    }
+}
+
+// Appends the replies of finished pool reads, in completion order, and lets each
+// connection carry on with its next request
+static void finish_reads(Server* srv) {
+    pthread_mutex_lock(&srv->done_lock);
+    ServerRead* read = srv->done;
+    srv->done = srv->done_tail = NULL;
+    pthread_mutex_unlock(&srv->done_lock);
+
+    while (read) {
+        ServerRead* next = read->next;
+        Connection* conn = read->conn;
+        conn->reading = NULL;
+        if (conn->closed) {
+            connection_free(conn);
+        } else {
+            if (read->reply) {
+                fwrite(read->reply, 1, read->reply_len, conn->stream);
+            } else {
+                cli_execute(&conn->session, read->line); // the worker had no memory for a stream
+            }
+            process_requests(srv, conn);
+            service_connection(srv, conn, 0);
+        }
+        free(read->reply);
+        free(read);
+        read = next;
+    }
+}
+
+int server_run(const ServerConfig* config) {
+    Server srv;
+    memset(&srv, 0, sizeof(srv));
+    srv.config = config;
+    if (bookspace_open(&config->database, &srv.bs) != BOOKSPACE_OK) {
+        fprintf(stderr, "Error: Failed to initialize database.\n");
+        return 1;
+    }
+
+    // This thread is the single writer; queries go to read-only connections on the pool
+    int readers = config->reader_threads < 0 ? reader_pool_default_threads() : config->reader_threads;
+    if (readers > 0 && reader_pool_open(&config->database, readers, &srv.pool) != BOOKSPACE_OK) {
+        fprintf(stderr, "Warning: reader pool unavailable, serving reads on the main thread.\n");
+        readers = 0;
+    }
+    pthread_mutex_init(&srv.done_lock, NULL);
+
+    int listen_fd = open_listener(config->socket_path);
+    srv.epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    srv.timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    srv.done_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (listen_fd < 0 || srv.epoll_fd < 0 || srv.timer_fd < 0 || srv.done_fd < 0) {
+        if (listen_fd >= 0) close(listen_fd);
+        if (srv.epoll_fd >= 0) close(srv.epoll_fd);
+        if (srv.timer_fd >= 0) close(srv.timer_fd);
+        if (srv.done_fd >= 0) close(srv.done_fd);
+        reader_pool_close(srv.pool);
+        pthread_mutex_destroy(&srv.done_lock);
+        bookspace_close(srv.bs);
+        return 1;
+    }
+    // data.ptr tells the sources apart: NULL = listener, &timer_fd = group timer,
+    // &done_fd = finished pool reads, else a Connection
+    struct epoll_event ev = { .events = EPOLLIN, .data.ptr = NULL };
+    epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, listen_fd, &ev);
+    struct epoll_event tev = { .events = EPOLLIN, .data.ptr = &srv.timer_fd };
+    epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.timer_fd, &tev);
+    struct epoll_event dev = { .events = EPOLLIN, .data.ptr = &srv.done_fd };
+    epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, srv.done_fd, &dev);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_stop_signal;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    stop_requested = 0;
+
+    fprintf(stderr, "Serving %s on %s (%d reader thread%s)\n", config->database.path, config->socket_path,
+            readers, readers == 1 ? "" : "s");
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!stop_requested) {
+        int ready = epoll_wait(srv.epoll_fd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int e = 0; e < ready; e++) {
+            void* source = events[e].data.ptr;
+            if (source == &srv.timer_fd) {
+                unsigned long long expirations;
+                while (read(srv.timer_fd, &expirations, sizeof(expirations)) > 0);
+                if (srv.group_open) {
+                    commit_group(&srv);
+                }
+                continue;
+            }
+            if (source == &srv.done_fd) {
+                eventfd_t finished;
+                eventfd_read(srv.done_fd, &finished);
+                finish_reads(&srv);
+                continue;
+            }
+            if (!source) {
+                int fd;
+                while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    Connection* client = connection_open(fd, srv.bs);
+                    struct epoll_event cev = { .events = EPOLLIN, .data.ptr = client };
+                    if (!client || epoll_ctl(srv.epoll_fd, EPOLL_CTL_ADD, fd, &cev) != 0) {
+                        if (client) connection_close(&srv, client);
+                        else close(fd);
+                    }
+                }
+                continue;
+            }
+
+            Connection* conn = source;
+            int failed = 0;
+            if (conn->reading) {
+                // Only hangups arrive while a read is out; the peer can no longer take the reply
+                failed = (events[e].events & (EPOLLHUP | EPOLLERR)) != 0;
+            } else if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                failed = handle_readable(&srv, conn) != 0;
+            }
+            service_connection(&srv, conn, failed);
+        }
+    }
+
+    // Acknowledge what was accepted before the signal; open connections are then dropped
+    if (srv.group_open) {
+        commit_group(&srv);
+    }
+    // Let the workers finish; their replies are dropped with the connections
+    reader_pool_close(srv.pool);
+    for (ServerRead* read = srv.done; read; ) {
+        ServerRead* next = read->next;
+        free(read->reply);
+        free(read);
+        read = next;
+    }
+    pthread_mutex_destroy(&srv.done_lock);
+    close(srv.done_fd);
+    close(srv.timer_fd);
+    close(srv.epoll_fd);
+    close(listen_fd);
+    unlink(config->socket_path);
+    bookspace_close(srv.bs);
+    free(srv.group);
+    fprintf(stderr, "Server stopped.\n");
+    return 0;
+}
+
+static int connect_socket(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "Socket path too long: %s\n", path);
+        return -1;
+    }
+    strcpy(addr.sun_path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "Cannot connect to %s: %s\n", path, strerror(errno));
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Error status lines: "error<TAB>..." or {"error":...}
+static int is_error_line(const char* line, size_t len) {
+    return (len >= 6 && memcmp(line, "error\t", 6) == 0) || (len >= 9 && memcmp(line, "{\"error\":", 9) == 0);
+}
+
+int client_run(const char* socket_path, FILE* in, const char* request, FILE* out) {
+    int fd = connect_socket(socket_path);
+    if (fd < 0) {
+        return CLI_FAILED;
+    }
+    set_nonblocking(fd);
+
+    ByteBuffer pending = { NULL, 0, 0 };
+    size_t sent = 0;
+    int input_done = 0;
+    if (request) {
+        size_t len = strlen(request);
+        if (buffer_reserve(&pending, len + 1) == 0) {
+            memcpy(pending.data, request, len);
+            pending.data[len] = '\n';
+            pending.len = len + 1;
+        }
+        input_done = 1;
+    }
+
+    char line[CLI_MAX_LINE];
+    char reply[SERVER_READ_CHUNK];
+    size_t line_len = 0;
+    int status = CLI_OK;
+    int write_open = 1;
+
+    // Send and receive at the same time, so a long pipeline cannot deadlock on full buffers
+    for (;;) {
+        while (!input_done && pending.len - sent < SERVER_READ_CHUNK) {
+            if (!fgets(line, sizeof(line), in)) {
+                input_done = 1;
+                break;
+            }
+            size_t len = strlen(line);
+            if (buffer_reserve(&pending, len + 1) != 0) {
+                input_done = 1;
+                break;
+            }
+            memcpy(pending.data + pending.len, line, len);
+            pending.len += len;
+            if (len > 0 && line[len - 1] != '\n' && feof(in)) {
+                pending.data[pending.len++] = '\n'; // last line without a newline
+            }
+        }
+        if (write_open && input_done && sent == pending.len) {
+            shutdown(fd, SHUT_WR);
+            write_open = 0;
+        }
+
+        struct pollfd pfd = { fd, POLLIN | (write_open && sent < pending.len ? POLLOUT : 0), 0 };
+        if (poll(&pfd, 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            status = CLI_FAILED;
+            break;
+        }
+
+        if (pfd.revents & POLLOUT) {
+            ssize_t n = send(fd, pending.data + sent, pending.len - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += (size_t)n;
+                if (sent == pending.len) sent = pending.len = 0;
+            } else if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                status = CLI_FAILED;
+                break;
+            }
+        }
+        if (pfd.revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t n = recv(fd, reply, sizeof(reply), 0);
+            if (n == 0) break;
+            if (n < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) continue;
+                status = CLI_FAILED;
+                break;
+            }
+            fwrite(reply, 1, (size_t)n, out);
+
+            // Watch line starts for error replies
+            for (ssize_t i = 0; i < n; i++) {
+                if (line_len < sizeof(line)) line[line_len++] = reply[i];
+                if (reply[i] == '\n') {
+                    if (is_error_line(line, line_len)) status = CLI_FAILED;
+                    line_len = 0;
+                }
+            }
+        }
+    }
+
+    free(pending.data);
+    close(fd);
+    fflush(out);
+    return status;
+}
+
+#else
+
+int server_run(const ServerConfig* config) {
+    (void)config;
+    fprintf(stderr, "Server mode needs Linux (epoll).\n");
+    return 1;
+}
+
+int client_run(const char* socket_path, FILE* in, const char* request, FILE* out) {
+    (void)socket_path; (void)in; (void)request; (void)out;
+    fprintf(stderr, "Client mode needs Linux.\n");
+    return CLI_FAILED;
+}
+
+#endif
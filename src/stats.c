@@ -0,0 +1,225 @@
+#include "headers/stats.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+    _Atomic(const char*) name;
+    atomic_llong count;
+    atomic_llong total_ns;
+    atomic_llong buckets[STATS_BUCKETS];
+} StatsSeries;
+
+typedef struct {
+    const char* name;
+    char sql[STATS_SQL_LENGTH];
+    long long us;
+    time_t when;
+} SlowQuery;
+
+static const char* OP_NAMES[STATS_OP_COUNT] = {
+    [STATS_OP_BOOK] = "book",
+    [STATS_OP_CANCEL] = "cancel",
+    [STATS_OP_EDIT] = "edit",
+    [STATS_OP_SEARCH] = "search",
+    [STATS_OP_LIST] = "list"
+};
+
+static atomic_int enabled = 0;
+static atomic_long slow_threshold_us = 0;
+static StatsSeries statements[STATS_MAX_STATEMENTS];
+static StatsSeries operations[STATS_OP_COUNT];
+
+// Slow-query ring; a spin lock is enough for a copy of a few hundred bytes
+static atomic_flag slow_lock = ATOMIC_FLAG_INIT;
+static SlowQuery slow_log[STATS_SLOW_LOG_SIZE];
+static long long slow_total = 0;
+
+void stats_enable(long slow_query_us) {
+    atomic_store(&slow_threshold_us, slow_query_us);
+    atomic_store(&enabled, 1);
+}
+
+int stats_enabled(void) {
+    return atomic_load_explicit(&enabled, memory_order_relaxed);
+}
+
+long long stats_now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static int bucket_of(long long ns) {
+    long long us = ns / 1000;
+    int b = 0;
+    while (b < STATS_BUCKETS - 1 && us >= (1LL << b)) b++;
+    return b;
+}
+
+static void series_add(StatsSeries* series, long long ns) {
+    if (ns < 0) ns = 0;
+    atomic_fetch_add_explicit(&series->count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&series->total_ns, ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&series->buckets[bucket_of(ns)], 1, memory_order_relaxed);
+}
+
+long long stats_start(void) {
+    return stats_enabled() ? stats_now_ns() : 0;
+}
+
+void stats_finish(StatsOp op, long long started) {
+    if (started != 0 && op >= 0 && op < STATS_OP_COUNT) {
+        series_add(&operations[op], stats_now_ns() - started);
+    }
+}
+
+void stats_record_statement(int slot, const char* name, const char* sql, long long ns) {
+    if (slot < 0 || slot >= STATS_MAX_STATEMENTS) {
+        slot = STATS_MAX_STATEMENTS - 1;
+    }
+    StatsSeries* series = &statements[slot];
+    if (!atomic_load_explicit(&series->name, memory_order_relaxed)) {
+        atomic_store(&series->name, name);
+    }
+    series_add(series, ns);
+
+    long threshold = atomic_load_explicit(&slow_threshold_us, memory_order_relaxed);
+    if (threshold > 0 && ns / 1000 >= threshold) {
+        while (atomic_flag_test_and_set_explicit(&slow_lock, memory_order_acquire));
+        SlowQuery* entry = &slow_log[slow_total % STATS_SLOW_LOG_SIZE];
+        entry->name = name;
+        snprintf(entry->sql, sizeof(entry->sql), "%s", sql ? sql : "");
+        for (char* c = entry->sql; *c; c++) {
+            if (*c == '\n' || *c == '\r') *c = ' '; // one line per entry in both formats
+        }
+        entry->us = ns / 1000;
+        entry->when = time(NULL);
+        slow_total++;
+        atomic_flag_clear_explicit(&slow_lock, memory_order_release);
+    }
+}
+
+//OUTPUT
+
+static void write_json_string(FILE* out, const char* str) {
+    putc('"', out);
+    for (; *str; str++) {
+        unsigned char c = (unsigned char)*str;
+        if (c == '"' || c == '\\') {
+            putc('\\', out);
+            putc(c, out);
+        } else if (c < 0x20) {
+            fprintf(out, "\\u%04x", c);
+        } else {
+            putc(c, out);
+        }
+    }
+    putc('"', out);
+}
+
+static void write_json_series(FILE* out, const char* key, const char* name, StatsSeries* series) {
+    long long count = atomic_load(&series->count);
+    long long total_ns = atomic_load(&series->total_ns);
+    fprintf(out, "{\"%s\":", key);
+    write_json_string(out, name);
+    fprintf(out, ",\"count\":%lld,\"total_us\":%lld,\"mean_us\":%.3f,\"histogram\":[",
+            count, total_ns / 1000, count ? total_ns / 1000.0 / count : 0.0);
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        fprintf(out, "%s%lld", b ? "," : "", atomic_load(&series->buckets[b]));
+    }
+    fputs("]}", out);
+}
+
+static void write_json(FILE* out) {
+    fprintf(out, "{\"enabled\":%s,\"slow_query_us\":%ld,\"histogram_upper_us\":[",
+            stats_enabled() ? "true" : "false", atomic_load(&slow_threshold_us));
+    for (int b = 0; b < STATS_BUCKETS - 1; b++) {
+        fprintf(out, "%s%lld", b ? "," : "", 1LL << b);
+    }
+    fputs(",null],\n\"statements\":[", out);
+    int first = 1;
+    for (int i = 0; i < STATS_MAX_STATEMENTS; i++) {
+        const char* name = atomic_load(&statements[i].name);
+        if (!name) continue;
+        fputs(first ? "\n  " : ",\n  ", out);
+        write_json_series(out, "statement", name, &statements[i]);
+        first = 0;
+    }
+    fputs("],\n\"operations\":[", out);
+    for (int op = 0; op < STATS_OP_COUNT; op++) {
+        fputs(op ? ",\n  " : "\n  ", out);
+        write_json_series(out, "operation", OP_NAMES[op], &operations[op]);
+    }
+
+    while (atomic_flag_test_and_set_explicit(&slow_lock, memory_order_acquire));
+    long long total = slow_total;
+    fprintf(out, "],\n\"slow_query_total\":%lld,\"slow_queries\":[", total);
+    long long oldest = total > STATS_SLOW_LOG_SIZE ? total - STATS_SLOW_LOG_SIZE : 0;
+    for (long long n = oldest; n < total; n++) {
+        const SlowQuery* entry = &slow_log[n % STATS_SLOW_LOG_SIZE];
+        fprintf(out, "%s{\"statement\":", n > oldest ? ",\n  " : "\n  ");
+        write_json_string(out, entry->name);
+        fprintf(out, ",\"us\":%lld,\"at\":%lld,\"sql\":", entry->us, (long long)entry->when);
+        write_json_string(out, entry->sql);
+        putc('}', out);
+    }
+    atomic_flag_clear_explicit(&slow_lock, memory_order_release);
+    fputs("]}\n", out);
+}
+
+static void write_prometheus_series(FILE* out, const char* metric, const char* label, const char* name,
+                                    StatsSeries* series) {
+    long long cumulative = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        cumulative += atomic_load(&series->buckets[b]);
+        if (b < STATS_BUCKETS - 1) {
+            fprintf(out, "%s_bucket{%s=\"%s\",le=\"%g\"} %lld\n", metric, label, name, (1LL << b) / 1e6, cumulative);
+        } else {
+            fprintf(out, "%s_bucket{%s=\"%s\",le=\"+Inf\"} %lld\n", metric, label, name, cumulative);
+        }
+    }
+    fprintf(out, "%s_sum{%s=\"%s\"} %.9f\n", metric, label, name, atomic_load(&series->total_ns) / 1e9);
+    fprintf(out, "%s_count{%s=\"%s\"} %lld\n", metric, label, name, atomic_load(&series->count));
+}
+
+static void write_prometheus(FILE* out) {
+    fputs("# HELP bookspace_statement_seconds SQLite statement run time, from first step to reset.\n"
+          "# TYPE bookspace_statement_seconds histogram\n", out);
+    for (int i = 0; i < STATS_MAX_STATEMENTS; i++) {
+        const char* name = atomic_load(&statements[i].name);
+        if (name) {
+            write_prometheus_series(out, "bookspace_statement_seconds", "statement", name, &statements[i]);
+        }
+    }
+    fputs("# HELP bookspace_operation_seconds Library call time, including validation and caches.\n"
+          "# TYPE bookspace_operation_seconds histogram\n", out);
+    for (int op = 0; op < STATS_OP_COUNT; op++) {
+        write_prometheus_series(out, "bookspace_operation_seconds", "operation", OP_NAMES[op], &operations[op]);
+    }
+
+    // The log itself is not a metric; the latest entries follow as comments
+    while (atomic_flag_test_and_set_explicit(&slow_lock, memory_order_acquire));
+    long long total = slow_total;
+    fprintf(out, "# HELP bookspace_slow_queries_total Statements slower than %ld us.\n"
+                 "# TYPE bookspace_slow_queries_total counter\n"
+                 "bookspace_slow_queries_total %lld\n", atomic_load(&slow_threshold_us), total);
+    long long oldest = total > STATS_SLOW_LOG_SIZE ? total - STATS_SLOW_LOG_SIZE : 0;
+    for (long long n = oldest; n < total; n++) {
+        const SlowQuery* entry = &slow_log[n % STATS_SLOW_LOG_SIZE];
+        fprintf(out, "# slow %s %lldus %lld %s\n", entry->name, entry->us, (long long)entry->when, entry->sql);
+    }
+    atomic_flag_clear_explicit(&slow_lock, memory_order_release);
+}
+
+int stats_write(FILE* out, StatsFormat format) {
+    if (format == STATS_FORMAT_PROMETHEUS) {
+        write_prometheus(out);
+    } else {
+        write_json(out);
+    }
+    fflush(out);
+    return ferror(out) ? 1 : 0;
+}
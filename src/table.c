@@ -0,0 +1,115 @@
+#include "headers/table.h"
+#include "headers/reservation.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TABLE_BORDER "+-------------------------------+------------+-----------------+------------+------------+---------------------------+\n"
+#define TABLE_RULE   "|-------------------------------|------------|-----------------|------------|------------|---------------------------|\n"
+
+// Column widths of "| %-29s | %-10s | %-15s | %-10s | %-10s | %-25s |"
+// (the ID column fits RESERVATION_ID_SIZE - 1 characters)
+#define WIDTH_ID 29
+#define WIDTH_DATE 10
+#define WIDTH_ROOM 15
+#define WIDTH_TIME 10
+#define WIDTH_NAME 25
+#define WIDTH_MESSAGE 114 // spans all columns and separators
+
+void table_init(TableRenderer* table, FILE* out) {
+    table->out = out;
+    table->len = 0;
+}
+
+int table_flush(TableRenderer* table) {
+    if (table->len > 0 && fwrite(table->buf, 1, table->len, table->out) != table->len) {
+        table->len = 0;
+        return 1;
+    }
+    table->len = 0;
+    return 0;
+}
+
+static void table_write(TableRenderer* table, const char* text, size_t len) {
+    if (table->len + len > TABLE_BUFFER_SIZE) {
+        table_flush(table);
+        if (len > TABLE_BUFFER_SIZE) {
+            fwrite(text, 1, len, table->out);
+            return;
+        }
+    }
+    memcpy(table->buf + table->len, text, len);
+    table->len += len;
+}
+
+// Same as printf("%-*s", width, text): pad to width, never truncate
+static void table_pad(TableRenderer* table, const char* text, size_t len, size_t width) {
+    table_write(table, text, len);
+    if (len < width) {
+        size_t pad = width - len;
+        if (table->len + pad > TABLE_BUFFER_SIZE) {
+            table_flush(table);
+        }
+        memset(table->buf + table->len, ' ', pad);
+        table->len += pad;
+    }
+}
+
+static void table_cell(TableRenderer* table, const char* text, size_t len, size_t width, int last) {
+    table_pad(table, text, len, width);
+    if (last) {
+        table_write(table, " |\n", 3);
+    } else {
+        table_write(table, " | ", 3);
+    }
+}
+
+void table_border(TableRenderer* table) {
+    table_write(table, TABLE_BORDER, sizeof(TABLE_BORDER) - 1);
+}
+
+void table_rule(TableRenderer* table) {
+    table_write(table, TABLE_RULE, sizeof(TABLE_RULE) - 1);
+}
+
+void table_cells(TableRenderer* table, const char* reservation_id, const char* date, const char* room,
+                 const char* start_time, const char* end_time, const char* student_name) {
+    table_write(table, "| ", 2);
+    table_cell(table, reservation_id, strlen(reservation_id), WIDTH_ID, 0);
+    table_cell(table, date, strlen(date), WIDTH_DATE, 0);
+    table_cell(table, room, strlen(room), WIDTH_ROOM, 0);
+    table_cell(table, start_time, strlen(start_time), WIDTH_TIME, 0);
+    table_cell(table, end_time, strlen(end_time), WIDTH_TIME, 0);
+    table_cell(table, student_name, strlen(student_name), WIDTH_NAME, 1);
+}
+
+void table_header(TableRenderer* table, const char* start_label, const char* end_label) {
+    table_cells(table, "Reservation ID", "Date", "Room", start_label, end_label, "Student Name");
+}
+
+void table_message(TableRenderer* table, const char* message) {
+    table_write(table, "| ", 2);
+    table_cell(table, message, strlen(message), WIDTH_MESSAGE, 1);
+}
+
+int table_row(const ReservationRow* row, void* data) {
+    TableRenderer* table = data;
+    char date[MAX_DATE_LENGTH];
+    char start_12[MAX_TIME_LENGTH], end_12[MAX_TIME_LENGTH];
+
+    day_number_to_date(row->day, date);
+    int start_len = minutes_to_time_12hour(row->start_min, start_12);
+    int end_len = minutes_to_time_12hour(row->end_min, end_12);
+
+    table_write(table, "| ", 2);
+    table_cell(table, row->reservation_id, strlen(row->reservation_id), WIDTH_ID, 0);
+    table_cell(table, date, MAX_DATE_LENGTH - 1, WIDTH_DATE, 0);
+    table_cell(table, row->consultation_room, strlen(row->consultation_room), WIDTH_ROOM, 0);
+    table_cell(table, start_12, start_len, WIDTH_TIME, 0);
+    table_cell(table, end_12, end_len, WIDTH_TIME, 0);
+    table_cell(table, row->name, strlen(row->name), WIDTH_NAME, 1);
+    return 0;
+}
+
+int table_reservations(TableRenderer* table, ReservationCursor* cursor) {
+    return for_each_reservation(cursor, table_row, table);
+}
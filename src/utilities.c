@@ -1,9 +1,19 @@
+#define _POSIX_C_SOURCE 200809L // gethostname
 #include "headers/main.h"
+#include "headers/reservation.h"
 #include "headers/database.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <time.h>
+#include <stdatomic.h>
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
 
 void clear_input_buffer() {
     int c;
@@ -36,4 +46,117 @@ int check_cancel_string(const char* input) {
     return strcmp(temp, "cancel") == 0;
 }   //  checks if the input string equals "cancel" (case-insensitively), 
     //returning 1 if true and 0 otherwise. It creates a lowercase copy of the input 
-    //and compares it
\ No newline at end of file
+    //and compares it
+
+
+// Reservation IDs: MMDDYY-MMDDYY-NNNN-SSSSSSSSSS
+//   today's date, reservation date (human-readable prefix),
+//   NNNN = node discriminator for this host/process/terminal,
+//   SSSSSSSSSS = per-process sequence, seeded from the microsecond clock so a restarted
+//   process continues past the previous one. Both are base-36 and fixed width.
+// Unique without a database round trip as long as no two live processes share a node,
+// and across restarts of a node as long as it hands out fewer than one ID per microsecond
+// on average (a restart seeds the sequence from the clock, which must be past the last ID).
+#define ID_NODE_DIGITS 4
+#define ID_SEQUENCE_DIGITS 10
+#define ID_NODE_RANGE (36UL * 36 * 36 * 36)
+
+static _Atomic unsigned long long id_sequence = 0;
+static _Atomic unsigned long id_node = 0; // stored as node + 1, 0 = not chosen yet
+
+static const char BASE36[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+static unsigned long hash_string(const char* text, unsigned long hash) {
+    // FNV-1a
+    while (*text) {
+        hash = (hash ^ (unsigned char)*text++) * 16777619UL;
+    }
+    return hash & 0xFFFFFFFFUL;
+}
+
+void set_reservation_id_node(const char* node_name) {
+    atomic_store(&id_node, hash_string(node_name, 2166136261UL) % ID_NODE_RANGE + 1);
+}
+
+static unsigned long reservation_id_node() {
+    unsigned long node = atomic_load_explicit(&id_node, memory_order_relaxed);
+    if (node != 0) {
+        return node - 1;
+    }
+
+    // BOOKSPACE_NODE names a terminal explicitly; otherwise host name + process id
+    const char* configured = getenv("BOOKSPACE_NODE");
+    if (configured && *configured) {
+        set_reservation_id_node(configured);
+    } else {
+        char host[256] = "";
+#ifdef _WIN32
+        DWORD host_size = sizeof(host);
+        GetComputerNameA(host, &host_size);
+        unsigned long pid = (unsigned long)_getpid();
+#else
+        gethostname(host, sizeof(host) - 1);
+        unsigned long pid = (unsigned long)getpid();
+#endif
+        unsigned long hash = hash_string(host, 2166136261UL);
+        hash = (hash ^ pid) * 2654435761UL;
+        unsigned long expected = 0;
+        atomic_compare_exchange_strong(&id_node, &expected, (hash & 0xFFFFFFFFUL) % ID_NODE_RANGE + 1);
+    }
+    return atomic_load(&id_node) - 1;
+}
+
+static unsigned long long next_sequence() {
+    // First ID of the process: seed the counter from the clock before anyone counts.
+    // Threads racing here all try 0 -> clock and exactly one wins; none counts from 0.
+    if (atomic_load_explicit(&id_sequence, memory_order_relaxed) == 0) {
+        struct timespec now;
+        timespec_get(&now, TIME_UTC);
+        unsigned long long start = (unsigned long long)now.tv_sec * 1000000ULL + (unsigned long long)now.tv_nsec / 1000;
+        unsigned long long expected = 0;
+        atomic_compare_exchange_strong(&id_sequence, &expected, start);
+    }
+    return atomic_fetch_add_explicit(&id_sequence, 1, memory_order_relaxed);
+}
+
+static void put_base36(char* out, unsigned long long value, int digits) {
+    for (int i = digits - 1; i >= 0; i--) {
+        out[i] = BASE36[value % 36];
+        value /= 36;
+    }
+}
+
+static void put_two_digits(char* out, int value) {
+    out[0] = (char)('0' + value / 10 % 10);
+    out[1] = (char)('0' + value % 10);
+}
+
+void generate_reservation_id(char* out_id, size_t out_size, const char* reservation_date) {
+    // Example: 101726-110526-3KQZ-0H3F9X2ABC
+    if (out_size < RESERVATION_ID_SIZE) {
+        if (out_size > 0) out_id[0] = '\0';
+        return;
+    }
+
+    int year, month, day;
+    split_day_number(today_day_number(), &year, &month, &day);
+    put_two_digits(out_id, month);
+    put_two_digits(out_id + 2, day);
+    put_two_digits(out_id + 4, year % 100);
+    out_id[6] = '-';
+
+    // Reservation date from MM/DD/YYYY, 000000 if malformed
+    if (date_to_day_number(reservation_date) >= 0) {
+        memcpy(out_id + 7, reservation_date, 2);
+        memcpy(out_id + 9, reservation_date + 3, 2);
+        memcpy(out_id + 11, reservation_date + 8, 2);
+    } else {
+        memcpy(out_id + 7, "000000", 6);
+    }
+    out_id[13] = '-';
+
+    put_base36(out_id + 14, reservation_id_node(), ID_NODE_DIGITS);
+    out_id[14 + ID_NODE_DIGITS] = '-';
+    put_base36(out_id + 15 + ID_NODE_DIGITS, next_sequence(), ID_SEQUENCE_DIGITS);
+    out_id[RESERVATION_ID_SIZE - 1] = '\0';
+}
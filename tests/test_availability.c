@@ -0,0 +1,95 @@
+#include "test_util.h"
+
+// Availability answers are exact to the minute (user-005): the 5-minute slot bitmaps only
+// prefilter, so bookings and room hours that end mid-slot must not hide free time.
+
+static BookspaceResult book(Bookspace* bs, const char* date, const char* start, const char* end, const char* room) {
+    BookingRequest request = {
+        .name = "Ann Lee",
+        .student_num = "20231234-A",
+        .date = date,
+        .start_time = start,
+        .end_time = end,
+        .consultation_room = room,
+    };
+    return bookspace_book(bs, &request, NULL, 0);
+}
+
+static int room_free(Bookspace* bs, const char* date, const char* start, const char* end, const char* room) {
+    int available = -1;
+    CHECK_RESULT(bookspace_room_available(bs, date, start, end, room, &available), BOOKSPACE_OK);
+    return available;
+}
+
+static int in_free_rooms(Bookspace* bs, const char* date, const char* start, const char* end, int room) {
+    int rooms[16];
+    int count = 0;
+    CHECK_RESULT(bookspace_free_rooms(bs, date, start, end, rooms, &count), BOOKSPACE_OK);
+    for (int i = 0; i < count; i++) {
+        if (rooms[i] == room) return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    Bookspace* bs = open_fresh_database("test_availability.db");
+    if (!bs) return 1;
+
+    char date[MAX_DATE_LENGTH];
+    future_date(7, date);
+    int room_a = bookspace_find_room(bs, "Room A");
+    CHECK(room_a >= 0);
+    CHECK(bookspace_room_count(bs) <= 16);
+
+    // Room A busy 8:00-9:02; every other room busy 8:00-10:00
+    CHECK_RESULT(book(bs, date, "8:00AM", "9:02AM", "Room A"), BOOKSPACE_OK);
+    for (int r = 0; r < bookspace_room_count(bs); r++) {
+        if (r != room_a) {
+            CHECK_RESULT(book(bs, date, "8:00AM", "10:00AM", bookspace_room(bs, r)->name), BOOKSPACE_OK);
+        }
+    }
+
+    // The slot 9:00-9:05 is partly booked; the minutes after 9:02 are still free
+    CHECK_INT(room_free(bs, date, "9:02AM", "9:30AM", "Room A"), 1);
+    CHECK_INT(room_free(bs, date, "9:03AM", "10:00AM", "Room A"), 1);
+    CHECK_INT(room_free(bs, date, "9:01AM", "9:30AM", "Room A"), 0);
+    CHECK_INT(room_free(bs, date, "8:55AM", "9:00AM", "Room A"), 0);
+    CHECK_INT(room_free(bs, date, "9:03AM", "10:00AM", "Room B"), 0);
+
+    CHECK_INT(in_free_rooms(bs, date, "9:02AM", "9:30AM", room_a), 1);
+    CHECK_INT(in_free_rooms(bs, date, "9:03AM", "9:04AM", room_a), 1);
+    CHECK_INT(in_free_rooms(bs, date, "9:01AM", "9:30AM", room_a), 0);
+
+    // The first free window starts at the exact minute, in the only room free by then
+    int start = -2, room = -2;
+    CHECK_RESULT(bookspace_next_free(bs, date, "8:00AM", 30, "Room A", &start, &room), BOOKSPACE_OK);
+    CHECK_INT(start, 9 * 60 + 2);
+    CHECK_INT(room, room_a);
+    CHECK_RESULT(bookspace_next_free(bs, date, "8:00AM", 30, NULL, &start, &room), BOOKSPACE_OK);
+    CHECK_INT(start, 9 * 60 + 2);
+    CHECK_INT(room, room_a);
+    CHECK_RESULT(bookspace_next_free(bs, date, "8:00AM", 30, "Room B", &start, &room), BOOKSPACE_OK);
+    CHECK_INT(start, 10 * 60);
+
+    // Room hours that end mid-slot: open until 11:57 AM exactly
+    int short_room = -1;
+    CHECK_RESULT(bookspace_add_room(bs, "Short Hours", 4, "10:00AM", "11:57AM", &short_room), BOOKSPACE_OK);
+    CHECK_INT(room_free(bs, date, "11:20AM", "11:57AM", "Short Hours"), 1);
+    CHECK_INT(room_free(bs, date, "11:20AM", "11:58AM", "Short Hours"), 0);
+    CHECK_INT(room_free(bs, date, "9:30AM", "10:30AM", "Short Hours"), 0);
+    CHECK_INT(in_free_rooms(bs, date, "11:52AM", "11:57AM", short_room), 1);
+    CHECK_RESULT(bookspace_next_free(bs, date, "11:27AM", 30, "Short Hours", &start, &room), BOOKSPACE_OK);
+    CHECK_INT(start, 11 * 60 + 27);
+    CHECK_RESULT(bookspace_next_free(bs, date, "11:28AM", 30, "Short Hours", &start, &room), BOOKSPACE_OK);
+    CHECK_INT(start, -1);
+
+    // A booking that ends mid-slot inside the short room
+    CHECK_RESULT(book(bs, date, "10:00AM", "10:33AM", "Short Hours"), BOOKSPACE_OK);
+    CHECK_INT(room_free(bs, date, "10:33AM", "10:40AM", "Short Hours"), 1);
+    CHECK_INT(room_free(bs, date, "10:32AM", "10:40AM", "Short Hours"), 0);
+    CHECK_RESULT(bookspace_next_free(bs, date, "10:00AM", 60, "Short Hours", &start, &room), BOOKSPACE_OK);
+    CHECK_INT(start, 10 * 60 + 33);
+
+    bookspace_close(bs);
+    return test_finish("test_availability");
+}
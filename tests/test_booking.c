@@ -0,0 +1,145 @@
+#include "test_util.h"
+#include "import.h"
+
+// Booking results through the public API: conflict detection, validation results
+// (user-014: an over-long reservation ID is invalid_id, not a database error) and the
+// importer, which books every row through the same path.
+
+static BookingRequest request_for(const char* date, const char* start, const char* end, const char* room) {
+    BookingRequest request = {
+        .name = "Ann Lee",
+        .student_num = "20231234-A",
+        .date = date,
+        .start_time = start,
+        .end_time = end,
+        .consultation_room = room,
+    };
+    return request;
+}
+
+static void test_conflicts(Bookspace* bs, const char* date) {
+    BookingRequest request = request_for(date, "10:00AM", "11:00AM", "Room A");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OK);
+
+    request = request_for(date, "10:30AM", "11:30AM", "Room A");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_CONFLICT);
+    request = request_for(date, "9:00AM", "10:01AM", "Room A");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_CONFLICT);
+    request = request_for(date, "10:15AM", "10:45AM", "Room A");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_CONFLICT);
+
+    // Touching ranges and other rooms do not conflict
+    request = request_for(date, "11:00AM", "12:00PM", "Room A");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OK);
+    request = request_for(date, "9:00AM", "10:00AM", "Room A");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OK);
+    request = request_for(date, "10:30AM", "11:30AM", "Room B");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OK);
+
+    // A cancelled booking frees its time
+    char id[MAX_RESERVATION_ID_LENGTH];
+    request = request_for(date, "2:00PM", "3:00PM", "Room C");
+    CHECK_RESULT(bookspace_book(bs, &request, id, sizeof(id)), BOOKSPACE_OK);
+    CHECK_RESULT(bookspace_cancel(bs, id), BOOKSPACE_OK);
+    CHECK_RESULT(bookspace_cancel(bs, id), BOOKSPACE_NOT_FOUND);
+    request = request_for(date, "2:30PM", "3:30PM", "Room C");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OK);
+}
+
+static void test_validation(Bookspace* bs, const char* date) {
+    char past[MAX_DATE_LENGTH];
+    day_number_to_date(today_day_number() - 1, past);
+
+    BookingRequest request = request_for(date, "1:00PM", "2:00PM", "Room D");
+    request.name = "B0b";
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_INVALID_NAME);
+    request = request_for(date, "1:00PM", "2:00PM", "Room D");
+    request.student_num = "2023-A";
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_INVALID_STUDENT_NUM);
+    request = request_for("13/01/2026", "1:00PM", "2:00PM", "Room D");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_INVALID_DATE);
+    request = request_for(past, "1:00PM", "2:00PM", "Room D");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_PAST_DATE);
+    request = request_for(date, "9:", "2:00PM", "Room D");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_INVALID_TIME);
+    request = request_for(date, "7:00AM", "9:00AM", "Room D");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OUTSIDE_HOURS);
+    request = request_for(date, "2:00PM", "1:00PM", "Room D");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_BAD_RANGE);
+    request = request_for(date, "1:00PM", "2:00PM", "Room Z");
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_UNKNOWN_ROOM);
+
+    // Caller-supplied IDs: too long is a validation result, a reused one a duplicate
+    char long_id[MAX_RESERVATION_ID_LENGTH + 8];
+    memset(long_id, 'X', sizeof(long_id) - 1);
+    long_id[sizeof(long_id) - 1] = '\0';
+    request = request_for(date, "1:00PM", "2:00PM", "Room D");
+    request.reservation_id = long_id;
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_INVALID_ID);
+    CHECK(strcmp(bookspace_result_name(BOOKSPACE_INVALID_ID), "invalid_id") == 0);
+    CHECK(strcmp(bookspace_result_message(BOOKSPACE_INVALID_ID), "Reservation ID is too long.") == 0);
+
+    request.reservation_id = "desk-0001";
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_OK);
+    request = request_for(date, "4:00PM", "5:00PM", "Room D");
+    request.reservation_id = "desk-0001";
+    CHECK_RESULT(bookspace_book(bs, &request, NULL, 0), BOOKSPACE_DUPLICATE_ID);
+
+    // Nothing was stored by the rejected requests
+    Reservation found;
+    CHECK_RESULT(bookspace_get(bs, long_id, &found), BOOKSPACE_NOT_FOUND);
+    CHECK_RESULT(bookspace_get(bs, "desk-0001", &found), BOOKSPACE_OK);
+    CHECK(strcmp(found.start_time, "13:00") == 0);
+}
+
+static void test_import(Bookspace* bs, const char* date) {
+    FILE* in = tmpfile();
+    FILE* rejects = tmpfile();
+    CHECK(in && rejects);
+    if (!in || !rejects) return;
+
+    fprintf(in, "student_name,student_num,date,start_time,end_time,consultation_room,reservation_id\n");
+    fprintf(in, "Cy Ray,20230001-B,%s,8:00AM,9:00AM,Room B,\n", date);            // line 2: ok
+    fprintf(in, "Cy Ray,20230001-B,%s,8:30AM,9:30AM,Room B,\n", date);            // line 3: conflict
+    fprintf(in, "Cy Ray,20230001-B,%s,10:00AM,11:00AM,Room A,\n", date);          // line 4: conflict with the API bookings
+    fprintf(in, "Cy Ray,20230001-B,%s,3:00PM,4:00PM,Room A,%s\n", date,
+            "XXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXXX"); // line 5: ID too long
+    fprintf(in, "\"Ray, Cy\",20230001-B,%s,3:00PM,4:00PM,Room A,\n", date);      // line 6: invalid name
+    fprintf(in, "Cy Ray,20230001-B,%s,3:00PM,4:00PM,Room A,import-0001\n", date); // line 7: ok
+    rewind(in);
+
+    ImportStats stats;
+    CHECK_INT(import_reservations(bs, in, 2, rejects, &stats), 0);
+    CHECK_INT(stats.rows, 6);
+    CHECK_INT(stats.imported, 2);
+    CHECK_INT(stats.rejected, 4);
+
+    char log[1024];
+    rewind(rejects);
+    size_t len = fread(log, 1, sizeof(log) - 1, rejects);
+    log[len] = '\0';
+    CHECK(strstr(log, "line 3: ") != NULL);
+    CHECK(strstr(log, "line 4: ") != NULL);
+    CHECK(strstr(log, "line 5: Reservation ID is too long.") != NULL);
+    CHECK(strstr(log, "line 6: ") != NULL);
+    CHECK(strstr(log, "line 2: ") == NULL && strstr(log, "line 7: ") == NULL);
+
+    Reservation found;
+    CHECK_RESULT(bookspace_get(bs, "import-0001", &found), BOOKSPACE_OK);
+    fclose(in);
+    fclose(rejects);
+}
+
+int main(void) {
+    Bookspace* bs = open_fresh_database("test_booking.db");
+    if (!bs) return 1;
+
+    char date[MAX_DATE_LENGTH];
+    future_date(10, date);
+    test_conflicts(bs, date);
+    test_validation(bs, date);
+    test_import(bs, date);
+
+    bookspace_close(bs);
+    return test_finish("test_booking");
+}
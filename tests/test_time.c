@@ -0,0 +1,64 @@
+#include "test_util.h"
+#include <stdlib.h>
+
+// time_to_minutes: every accepted form, and the malformed inputs that must fail
+// without reading past their terminator (user-011: "9:" ends right after the colon)
+
+// Parse from an exactly sized heap copy, so a sanitizer build catches any overrun
+static int parse_exact(const char* text) {
+    size_t size = strlen(text) + 1;
+    char* copy = malloc(size);
+    if (!copy) return -2;
+    memcpy(copy, text, size);
+    int minutes = time_to_minutes(copy);
+    free(copy);
+    return minutes;
+}
+
+int main(void) {
+    // 12-hour forms
+    CHECK_INT(parse_exact("9:05 AM"), 9 * 60 + 5);
+    CHECK_INT(parse_exact("9:05AM"), 9 * 60 + 5);
+    CHECK_INT(parse_exact("4PM"), 16 * 60);
+    CHECK_INT(parse_exact("4 pm"), 16 * 60);
+    CHECK_INT(parse_exact("12:00 AM"), 0);
+    CHECK_INT(parse_exact("12:30 PM"), 12 * 60 + 30);
+    CHECK_INT(parse_exact("11:59 PM"), 23 * 60 + 59);
+
+    // 24-hour forms need minutes
+    CHECK_INT(parse_exact("08:00"), 8 * 60);
+    CHECK_INT(parse_exact("8:00"), 8 * 60);
+    CHECK_INT(parse_exact("20:00"), 20 * 60);
+    CHECK_INT(parse_exact("23:59"), 23 * 60 + 59);
+    CHECK_INT(parse_exact("9"), -1);
+    CHECK_INT(parse_exact("24:00"), -1);
+
+    // Truncated input: each must stop at the terminator
+    CHECK_INT(parse_exact(""), -1);
+    CHECK_INT(parse_exact("9:"), -1);
+    CHECK_INT(parse_exact("10:"), -1);
+    CHECK_INT(parse_exact("9:5"), -1);
+    CHECK_INT(parse_exact("9:5 "), -1);
+    CHECK_INT(parse_exact("9:05 A"), -1);
+    CHECK_INT(parse_exact("9 P"), -1);
+
+    // Out of range or junk
+    CHECK_INT(parse_exact("9:60"), -1);
+    CHECK_INT(parse_exact("0 AM"), -1);
+    CHECK_INT(parse_exact("13 PM"), -1);
+    CHECK_INT(parse_exact("9:05 AMX"), -1);
+    CHECK_INT(parse_exact("9:05x"), -1);
+    CHECK_INT(parse_exact("123:00"), -1);
+    CHECK_INT(parse_exact(":30"), -1);
+
+    // Round trip through the display form
+    char text[MAX_TIME_LENGTH];
+    for (int minutes = 0; minutes < 24 * 60; minutes++) {
+        minutes_to_time_12hour(minutes, text);
+        CHECK_INT(time_to_minutes(text), minutes);
+        minutes_to_time_24hour(minutes, text);
+        CHECK_INT(time_to_minutes(text), minutes);
+    }
+
+    return test_finish("test_time");
+}
@@ -0,0 +1,73 @@
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include "bookspace.h"
+#include "reservation.h"
+#include <stdio.h>
+#include <string.h>
+
+// Minimal checks for the ctest behaviour tests: each failed check prints its location and
+// the test's main() returns the failure count, so ctest sees a non-zero exit status.
+
+static int test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_INT(actual, expected) \
+    do { \
+        long long actual_ = (long long)(actual), expected_ = (long long)(expected); \
+        if (actual_ != expected_) { \
+            fprintf(stderr, "%s:%d: %s is %lld, expected %lld\n", __FILE__, __LINE__, #actual, actual_, expected_); \
+            test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_RESULT(actual, expected) \
+    do { \
+        BookspaceResult actual_ = (actual), expected_ = (expected); \
+        if (actual_ != expected_) { \
+            fprintf(stderr, "%s:%d: %s is %s, expected %s\n", __FILE__, __LINE__, #actual, \
+                    bookspace_result_name(actual_), bookspace_result_name(expected_)); \
+            test_failures++; \
+        } \
+    } while (0)
+
+// A fresh database file in the working directory (the build tree under ctest)
+static inline Bookspace* open_fresh_database(const char* path) {
+    char sidecar[256];
+    remove(path);
+    snprintf(sidecar, sizeof(sidecar), "%s-wal", path);
+    remove(sidecar);
+    snprintf(sidecar, sizeof(sidecar), "%s-shm", path);
+    remove(sidecar);
+
+    DatabaseConfig config;
+    database_config_defaults(&config);
+    config.path = path;
+    Bookspace* bs = NULL;
+    if (bookspace_open(&config, &bs) != BOOKSPACE_OK) {
+        fprintf(stderr, "cannot open test database %s\n", path);
+        return NULL;
+    }
+    return bs;
+}
+
+// MM/DD/YYYY for today plus days_ahead
+static inline void future_date(int days_ahead, char* date) {
+    day_number_to_date(today_day_number() + days_ahead, date);
+}
+
+static inline int test_finish(const char* name) {
+    if (test_failures == 0) {
+        printf("%s: all checks passed\n", name);
+    }
+    return test_failures;
+}
+
+#endif // TEST_UTIL_H